@@ -0,0 +1,194 @@
+// Rows per second of WaterDataset::loadData on a synthetic EA export
+//
+//   load_benchmark [rows] [file]
+//
+// Writes `rows` (default 10M) synthetic rows to `file` (default a temporary
+// file) unless it already exists, then loads it a few times, and then a
+// single sampling point of it through its row index a few times. Every
+// load also reports the heap allocations it made per row.
+
+#include "dataset.hpp"
+#include "water_schema.hpp"
+#include <QCoreApplication>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <random>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+static const int RUNS = 3;
+
+// every operator new in the process, on any thread
+static atomic<size_t> allocations{0};
+
+void *operator new(size_t size) {
+  allocations.fetch_add(1, memory_order_relaxed);
+  if (void *memory = malloc(size ? size : 1))
+    return memory;
+  throw bad_alloc();
+}
+void operator delete(void *memory) noexcept { free(memory); }
+void operator delete(void *memory, size_t) noexcept { free(memory); }
+
+static void writeSynthetic(const string &path, size_t rows) {
+  ofstream out(path);
+  for (size_t c = 0; c < COLUMN_COUNT; c++)
+    out << (c ? "," : "") << COLUMN_NAMES[c];
+  out << "\n";
+
+  mt19937 random(42);
+  for (size_t r = 0; r < rows; r++) {
+    unsigned point = random() % 2000, determinand = random() % 300;
+    unsigned day = r / 5000 % 3650;
+    for (size_t c = 0; c < COLUMN_COUNT; c++) {
+      if (c)
+        out << ",";
+      switch ((Column)c) {
+      case Column::SamplingPointNotation:
+        out << "SP-" << point;
+        break;
+      case Column::SamplingPointNorthing:
+        out << 100000 + point * 37;
+        break;
+      case Column::SamplingPointEasting:
+        out << 400000 + point * 53;
+        break;
+      case Column::SamplingPointLabel:
+        out << "\"SITE " << point % 500 << ", RIVER\"";
+        break;
+      case Column::SamplePurpose:
+        out << "ENVIRONMENTAL MONITORING";
+        break;
+      case Column::SampledMaterialType:
+        out << "RIVER / RUNNING SURFACE WATER";
+        break;
+      case Column::SampleDateTime: {
+        char text[32];
+        snprintf(text, sizeof(text), "%04u-%02u-%02uT%02u:00:00",
+                 2015 + day / 365, day % 365 / 31 % 12 + 1, day % 28 + 1,
+                 unsigned(8 + r % 8));
+        out << text;
+        break;
+      }
+      case Column::IsComplianceSample:
+        out << (point % 3 ? "false" : "true");
+        break;
+      case Column::DeterminandNotation:
+        out << 1000 + determinand;
+        break;
+      case Column::DeterminandLabel:
+        out << "Det" << determinand;
+        break;
+      case Column::DeterminandDefinition:
+        out << "\"Synthetic determinand " << determinand << ", total\"";
+        break;
+      case Column::DeterminandUnitLabel:
+        out << "mg/l";
+        break;
+      case Column::Result:
+        out << (random() % 100000) / 100.0;
+        break;
+      }
+    }
+    out << "\n";
+  }
+}
+
+// The most memory the process has had resident so far, in MB; 0 where that
+// is not known
+static double peakResidentMB() {
+#ifndef _WIN32
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1e6; // bytes
+#else
+  return usage.ru_maxrss / 1e3; // kilobytes
+#endif
+#else
+  return 0;
+#endif
+}
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  size_t rows = argc > 1 ? stoull(argv[1]) : 10000000;
+  string path = argc > 2 ? argv[2]
+                         : (filesystem::temp_directory_path() /
+                            ("wq_synthetic_" + to_string(rows) + ".csv"))
+                               .string();
+
+  if (!filesystem::exists(path)) {
+    printf("writing %zu rows to %s\n", rows, path.c_str());
+    writeSynthetic(path, rows);
+  }
+  printf("%s: %.1f MB\n", path.c_str(), filesystem::file_size(path) / 1e6);
+
+  // text copied into the string pool, then left in the mapping
+  for (bool mapText : {false, true}) {
+    for (int run = 0; run < RUNS; run++) {
+      WaterDataset dataset;
+      dataset.setMapText(mapText);
+      size_t before = allocations.load(memory_order_relaxed);
+      auto start = chrono::steady_clock::now();
+      dataset.loadData(QString::fromStdString(path));
+      chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+      size_t made = allocations.load(memory_order_relaxed) - before;
+
+      size_t loaded = dataset.getColumns().rowCount();
+      printf("%s run %d: %zu rows in %.2f s, %.2f M rows/s, "
+             "%.3f allocations/row\n",
+             mapText ? "mapped" : "copied", run + 1, loaded, elapsed.count(),
+             loaded / elapsed.count() / 1e6,
+             (double)made / max<size_t>(1, loaded));
+    }
+  }
+  // mapped pages are given back as they are read, so this should be about
+  // one dataset rather than the file on top of it
+  printf("peak resident memory: %.0f MB\n", peakResidentMB());
+
+  // compressed copies made beside the file (gzip -k, zstd -k) and a JSON
+  // export of the same rows, if any
+  for (string variant : {path + ".gz", path + ".zst", path + ".json"}) {
+    if (!filesystem::exists(variant))
+      continue;
+    for (int run = 0; run < RUNS; run++) {
+      WaterDataset dataset;
+      size_t before = allocations.load(memory_order_relaxed);
+      auto start = chrono::steady_clock::now();
+      dataset.loadData(QString::fromStdString(variant));
+      chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+      size_t made = allocations.load(memory_order_relaxed) - before;
+
+      size_t loaded = dataset.getColumns().rowCount();
+      printf("%s run %d: %zu rows in %.2f s, %.2f M rows/s (%.1f MB read), "
+             "%.3f allocations/row\n",
+             variant.substr(variant.rfind('.') + 1).c_str(), run + 1,
+             loaded, elapsed.count(), loaded / elapsed.count() / 1e6,
+             filesystem::file_size(variant) / 1e6,
+             (double)made / max<size_t>(1, loaded));
+    }
+  }
+
+  // one site through the .idx row index, which the first of these builds
+  for (int run = 0; run < RUNS; run++) {
+    WaterDataset dataset;
+    auto start = chrono::steady_clock::now();
+    dataset.loadPoint(QString::fromStdString(path), "SP-7");
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    printf("point run %d: %zu rows in %.3f s\n", run + 1,
+           dataset.getColumns().rowCount(), elapsed.count());
+  }
+  return 0;
+}
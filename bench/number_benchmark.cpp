@@ -0,0 +1,75 @@
+// parseDouble() against CSVField::get<double>() on EA-like result values
+//
+//   number_benchmark [count]
+//
+// Also counts how often each disagrees with strtod, which rounds correctly.
+
+#include "csv.hpp"
+#include "numbers.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// concentrations down to 1e-6 ug/l, flow rates, counts, some in e notation
+static vector<string> makeValues(size_t count) {
+  mt19937_64 random(42);
+  vector<string> values;
+  char text[64];
+  for (size_t i = 0; i < count; i++) {
+    switch (i % 4) {
+    case 0:
+      snprintf(text, sizeof(text), "0.%06u", unsigned(random() % 1000000));
+      break;
+    case 1:
+      snprintf(text, sizeof(text), "%.3f", (random() % 10000000) / 997.0);
+      break;
+    case 2:
+      snprintf(text, sizeof(text), "%u", unsigned(random() % 100000));
+      break;
+    default:
+      snprintf(text, sizeof(text), "%.4e", (random() % 100000) * 1e-9);
+      break;
+    }
+    values.push_back(text);
+  }
+  return values;
+}
+
+template <typename Parse>
+static void run(const char *name, const vector<string> &values, Parse parse) {
+  double sum = 0;
+  size_t wrong = 0;
+  auto start = chrono::steady_clock::now();
+  for (const auto &value : values)
+    sum += parse(value);
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+  for (const auto &value : values) {
+    double parsed = parse(value), exact = strtod(value.c_str(), nullptr);
+    wrong += memcmp(&parsed, &exact, sizeof(double)) != 0;
+  }
+  printf("%-22s %7.1f M values/s, %zu of %zu not correctly rounded (sum %g)\n",
+         name, values.size() / elapsed.count() / 1e6, wrong, values.size(),
+         sum);
+}
+
+int main(int argc, char *argv[]) {
+  size_t count = argc > 1 ? stoull(argv[1]) : 10000000;
+  auto values = makeValues(count);
+
+  run("CSVField::get<double>", values, [](const string &value) {
+    return csv::CSVField(value).get<double>();
+  });
+  run("parseDouble", values, [](const string &value) {
+    double parsed = 0;
+    parseDouble(value, parsed);
+    return parsed;
+  });
+  return 0;
+}
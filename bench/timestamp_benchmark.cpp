@@ -0,0 +1,70 @@
+// TimestampParser::parse() against QDateTime::fromString on EA sample times
+//
+//   timestamp_benchmark [count]
+//
+// Also counts how often the two disagree, which should be never.
+
+#include "timestamp.hpp"
+#include <QDateTime>
+#include <QString>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// YYYY-MM-DDTHH:MM:SS over 2000-2029, mostly on the hour like EA samples
+static vector<string> makeValues(size_t count) {
+  mt19937 random(42);
+  vector<string> values;
+  char text[32];
+  for (size_t i = 0; i < count; i++) {
+    unsigned minute = i % 8 ? 0 : random() % 60;
+    snprintf(text, sizeof(text), "%04u-%02u-%02uT%02u:%02u:%02u",
+             2000 + unsigned(random() % 30), 1 + unsigned(random() % 12),
+             1 + unsigned(random() % 28), unsigned(random() % 24), minute,
+             i % 16 ? 0u : unsigned(random() % 60));
+    values.push_back(text);
+  }
+  return values;
+}
+
+static int64_t viaQDateTime(const string &value) {
+  QDateTime time = QDateTime::fromString(
+      QString::fromUtf8(value.data(), value.size()), Qt::ISODateWithMs);
+  return time.isValid() ? time.toMSecsSinceEpoch() : INT64_MIN;
+}
+
+template <typename Parse>
+static vector<int64_t> run(const char *name, const vector<string> &values,
+                           Parse parse) {
+  vector<int64_t> parsed;
+  parsed.reserve(values.size());
+  auto start = chrono::steady_clock::now();
+  for (const auto &value : values)
+    parsed.push_back(parse(value));
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  printf("%-24s %7.2f M values/s\n", name,
+         values.size() / elapsed.count() / 1e6);
+  return parsed;
+}
+
+int main(int argc, char *argv[]) {
+  size_t count = argc > 1 ? stoull(argv[1]) : 2000000;
+  auto values = makeValues(count);
+
+  auto slow = run("QDateTime::fromString", values, viaQDateTime);
+  TimestampParser parser;
+  auto fast = run("TimestampParser::parse", values, [&](const string &value) {
+    return parser.parse(value).value_or(INT64_MIN);
+  });
+
+  size_t differ = 0;
+  for (size_t i = 0; i < count; i++)
+    differ += slow[i] != fast[i];
+  printf("%zu of %zu values parsed differently\n", differ, count);
+  return 0;
+}
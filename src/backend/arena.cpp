@@ -0,0 +1,61 @@
+#include "arena.hpp"
+#include <cstdint>
+#include <cstring>
+
+using namespace std;
+
+Arena::Arena(Arena &&other) noexcept
+    : blockSize(other.blockSize), blocks(std::move(other.blocks)),
+      current(other.current), left(other.left), allocated(other.allocated) {
+  other.release();
+}
+
+Arena &Arena::operator=(Arena &&other) noexcept {
+  if (this != &other) {
+    blockSize = other.blockSize;
+    blocks = std::move(other.blocks);
+    current = other.current;
+    left = other.left;
+    allocated = other.allocated;
+    other.release();
+  }
+  return *this;
+}
+
+void *Arena::allocate(size_t bytes, size_t align) {
+  size_t padding = -reinterpret_cast<uintptr_t>(current) & (align - 1);
+
+  if (padding + bytes > left) {
+    // oversized requests get a block of their own
+    size_t size = max(blockSize, bytes + align);
+    blocks.emplace_back(new char[size]);
+    allocated += size;
+    if (size > blockSize) {
+      char *own = blocks.back().get();
+      return own + (-reinterpret_cast<uintptr_t>(own) & (align - 1));
+    }
+    current = blocks.back().get();
+    left = size;
+    padding = -reinterpret_cast<uintptr_t>(current) & (align - 1);
+  }
+
+  char *out = current + padding;
+  current = out + bytes;
+  left -= padding + bytes;
+  return out;
+}
+
+string_view Arena::copy(string_view text) {
+  if (text.empty())
+    return string_view();
+  char *out = static_cast<char *>(allocate(text.size(), 1));
+  memcpy(out, text.data(), text.size());
+  return string_view(out, text.size());
+}
+
+void Arena::release() {
+  blocks.clear();
+  current = nullptr;
+  left = 0;
+  allocated = 0;
+}
@@ -0,0 +1,37 @@
+// Monotonic arena for per-dataset allocations
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/*
+ * Hands out memory from large blocks and never frees individual
+ * allocations; everything goes away at once with the arena (or release()).
+ * Used for the dataset's interned text so ingest does not pay one malloc
+ * per distinct string.
+ */
+class Arena {
+public:
+  explicit Arena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+  Arena(Arena &&other) noexcept;
+  Arena &operator=(Arena &&other) noexcept;
+
+  void *allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+  // copies text into the arena, the view stays valid until release()
+  std::string_view copy(std::string_view text);
+  void release();
+
+  size_t bytesAllocated() const { return allocated; }
+
+private:
+  size_t blockSize;
+  std::vector<std::unique_ptr<char[]>> blocks;
+  char *current = nullptr;
+  size_t left = 0;
+  size_t allocated = 0;
+};
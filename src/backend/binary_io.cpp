@@ -0,0 +1,56 @@
+#include "binary_io.hpp"
+#include "csv.hpp"
+#include <filesystem>
+#include <fstream>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+uint64_t hashBytes(const char *data, size_t size) {
+  const uint64_t K = 0xff51afd7ed558ccdULL;
+  uint64_t h = 0x9e3779b97f4a7c15ULL ^ size;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    memcpy(&word, data + i, 8);
+    h = (h ^ word) * K;
+    h ^= h >> 32;
+  }
+  for (; i < size; i++) {
+    h = (h ^ (unsigned char)data[i]) * K;
+    h ^= h >> 32;
+  }
+  return h;
+}
+
+uint64_t sampleFile(const string &path) {
+  size_t size = fs::file_size(path);
+  if (size == 0)
+    return hashBytes(nullptr, 0);
+
+  error_code error;
+  mio::mmap_source file = mio::make_mmap_source(path, error);
+  if (error)
+    throw runtime_error("Unable to open " + path + ": " + error.message());
+  size_t head = min(size, SAMPLE_BYTES);
+  size_t tail = min(size - head, SAMPLE_BYTES);
+  return hashBytes(file.data(), head) ^
+         hashBytes(file.data() + size - tail, tail) * 31;
+}
+
+int64_t modifiedTime(const string &path) {
+  return fs::last_write_time(path).time_since_epoch().count();
+}
+
+void writeAtomically(const string &path, const void *header, size_t headerSize,
+                     const string &payload) {
+  string partial = path + ".tmp";
+  {
+    ofstream out(partial, ios::binary | ios::trunc);
+    out.write((const char *)header, headerSize);
+    out.write(payload.data(), payload.size());
+    if (!out)
+      throw runtime_error("Unable to write " + partial);
+  }
+  fs::rename(partial, path);
+}
@@ -0,0 +1,97 @@
+// Binary files kept next to a csv (snapshots, row indexes)
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Both are a fixed header followed by a payload of columns. A column is
+ * written as a count followed by the raw values, padded to 8 bytes so every
+ * column starts aligned. The header carries a hash of the payload and
+ * enough about the source csv to tell when it has changed.
+ */
+
+// Word at a time multiply-xor hash. Only used to notice changed or damaged
+// files, so it just has to be fast and mix well.
+uint64_t hashBytes(const char *data, size_t size);
+
+// bytes sampleFile() hashes at each end of the file
+static const size_t SAMPLE_BYTES = 64 * 1024;
+
+// Hash of the first and last SAMPLE_BYTES of `path`, which catches the
+// common edits to a csv (a new header, rows appended or trimmed) without
+// reading the rest. Throws std::runtime_error if it cannot be read.
+uint64_t sampleFile(const std::string &path);
+
+// modification time of `path` in the filesystem clock's ticks
+int64_t modifiedTime(const std::string &path);
+
+// Writes header + payload aside and renames it into place, so a reader never
+// sees half a file. Throws std::runtime_error if it cannot be written.
+void writeAtomically(const std::string &path, const void *header,
+                     size_t headerSize, const std::string &payload);
+
+class ColumnWriter {
+public:
+  // a std::vector or a ColumnData
+  template <typename Values> void column(const Values &values) {
+    uint64_t count = values.size();
+    append(&count, sizeof(count));
+    append(values.data(), count * sizeof(typename Values::value_type));
+  }
+
+  std::string payload;
+
+private:
+  void append(const void *data, size_t size) {
+    payload.append((const char *)data, size);
+    payload.resize((payload.size() + 7) & ~size_t(7), '\0');
+  }
+};
+
+// throws std::runtime_error if a column runs past the end of the payload
+class ColumnReader {
+public:
+  ColumnReader(const char *data, size_t size) : data(data), size(size) {}
+
+  template <typename T> void column(std::vector<T> &values) {
+    uint64_t count;
+    read(&count, sizeof(count));
+    if (count > (size - pos) / sizeof(T))
+      throw std::runtime_error("Truncated column");
+    values.resize(count);
+    read(values.data(), count * sizeof(T));
+  }
+  // The next column where it lies in the payload, without copying it. The
+  // payload must start 8-byte aligned for the values to be aligned.
+  template <typename T> const T *view(size_t &count) {
+    uint64_t stored;
+    read(&stored, sizeof(stored));
+    if (stored > (size - pos) / sizeof(T))
+      throw std::runtime_error("Truncated column");
+    count = stored;
+    const T *values = reinterpret_cast<const T *>(data + pos);
+    skip(count * sizeof(T));
+    return values;
+  }
+
+private:
+  void read(void *out, size_t bytes) {
+    if (bytes > size - pos)
+      throw std::runtime_error("Truncated column");
+    memcpy(out, data + pos, bytes);
+    skip(bytes);
+  }
+  void skip(size_t bytes) {
+    pos = std::min(size, (pos + bytes + 7) & ~size_t(7));
+  }
+
+  const char *data;
+  size_t size;
+  size_t pos = 0;
+};
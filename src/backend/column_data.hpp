@@ -0,0 +1,71 @@
+// One column of a ColumnStore, owning its values or borrowing them
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/*
+ * A column built by the loaders owns its values in a std::vector. One
+ * reopened from a snapshot instead borrows them where they lie in the
+ * mapped file, which it keeps alive, so reopening copies nothing.
+ *
+ * Reading never copies. The first change to a borrowed column (any
+ * non-const access) copies its values into the vector and lets go of the
+ * file; a store that is only displayed never does.
+ *
+ * Borrowed values must stay unchanged and suitably aligned for as long as
+ * the source lives.
+ */
+template <typename T> class ColumnData {
+public:
+  using value_type = T;
+
+  // the column reads values[0, count) until it is changed
+  void borrow(const T *values, size_t count,
+              std::shared_ptr<const void> source) {
+    owned.clear();
+    owned.shrink_to_fit();
+    borrowed = count ? values : nullptr;
+    borrowedCount = count;
+    this->source = count ? std::move(source) : nullptr;
+  }
+  bool isBorrowed() const { return borrowed != nullptr; }
+
+  size_t size() const { return borrowed ? borrowedCount : owned.size(); }
+  bool empty() const { return size() == 0; }
+  const T *data() const { return borrowed ? borrowed : owned.data(); }
+  const T &operator[](size_t i) const { return data()[i]; }
+  const T &back() const { return data()[size() - 1]; }
+  const T *begin() const { return data(); }
+  const T *end() const { return data() + size(); }
+
+  // the values as a vector that can be changed, copying borrowed ones first
+  std::vector<T> &values() {
+    if (borrowed) {
+      owned.assign(borrowed, borrowed + borrowedCount);
+      borrowed = nullptr;
+      borrowedCount = 0;
+      source.reset();
+    }
+    return owned;
+  }
+  T *data() { return values().data(); }
+  T &operator[](size_t i) { return values()[i]; }
+  T &back() { return values().back(); }
+  T *begin() { return data(); }
+  T *end() { return data() + size(); }
+
+  void push_back(const T &value) { values().push_back(value); }
+  void reserve(size_t count) { values().reserve(count); }
+  void resize(size_t count) { values().resize(count); }
+  void assign(size_t count, const T &value) { values().assign(count, value); }
+
+private:
+  std::vector<T> owned;
+  const T *borrowed = nullptr;
+  size_t borrowedCount = 0;
+  std::shared_ptr<const void> source;
+};
@@ -0,0 +1,829 @@
+#include "column_store.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// Stable counting sort of `keys`, returns the new position of every entry and
+// fills `offsets` with the first position of each key.
+static vector<uint32_t> groupBy(const ColumnData<uint32_t> &keys, size_t nkeys,
+                                vector<uint32_t> &offsets) {
+  offsets.assign(nkeys + 1, 0);
+  for (uint32_t key : keys)
+    offsets[key + 1]++;
+  for (size_t k = 0; k < nkeys; k++)
+    offsets[k + 1] += offsets[k];
+
+  vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+  vector<uint32_t> position(keys.size());
+  for (size_t i = 0; i < keys.size(); i++)
+    position[i] = next[keys[i]]++;
+  return position;
+}
+
+template <typename T>
+static void permute(ColumnData<T> &column, const vector<uint32_t> &position) {
+  vector<T> &values = column.values();
+  vector<T> out(values.size());
+  for (size_t i = 0; i < values.size(); i++)
+    out[position[i]] = std::move(values[i]);
+  values.swap(out);
+}
+
+uint32_t ColumnStore::addPoint(uint32_t notation, int northing, int easting,
+                               uint32_t label) {
+  uint32_t id = pointNotation.size();
+  pointNotation.push_back(notation);
+  pointLabel.push_back(label);
+  pointNorthing.push_back(northing);
+  pointEasting.push_back(easting);
+  pointIds[notation] = id;
+  labelPoints[label].push_back(id);
+  return id;
+}
+
+uint32_t ColumnStore::addSample(uint32_t point, bool isComplianceSample,
+                                uint32_t purpose, uint32_t dateTime,
+                                int64_t time, uint32_t sampledMaterialType) {
+  if (!samplesIndexed)
+    indexSamples();
+  uint32_t id = samplePoint.size();
+  samplePoint.push_back(point);
+  sampleIsCompliance.push_back(isComplianceSample);
+  samplePurpose.push_back(purpose);
+  sampleDateTime.push_back(dateTime);
+  sampleTime.push_back(time);
+  sampleMaterialType.push_back(sampledMaterialType);
+  sampleIds[shardOf(point)][sampleKey(point, dateTime)] = id;
+  return id;
+}
+
+uint32_t ColumnStore::addDeterminand(uint32_t label, uint32_t definition,
+                                     uint32_t notation, uint32_t unitLabel) {
+  uint32_t id = determinandNotation.size();
+  determinandLabel.push_back(label);
+  determinandDefinition.push_back(definition);
+  determinandNotation.push_back(notation);
+  determinandUnitLabel.push_back(unitLabel);
+  determinandIds[notation] = id;
+  return id;
+}
+
+void ColumnStore::addRow(uint32_t sample, uint32_t determinand,
+                         double result) {
+  rowPoint.push_back(samplePoint[sample]);
+  rowSample.push_back(sample);
+  rowDeterminand.push_back(determinand);
+  rowResult.push_back(result);
+}
+
+void ColumnStore::reserveRows(size_t rows) {
+  rowPoint.reserve(rows);
+  rowSample.reserve(rows);
+  rowDeterminand.reserve(rows);
+  rowResult.reserve(rows);
+}
+
+int ColumnStore::findPoint(uint32_t notation) const {
+  auto p = pointIds.find(notation);
+  if (p == pointIds.end())
+    return -1;
+  return p->second;
+}
+
+int ColumnStore::findPoint(string_view notation) const {
+  int id = strings.find(notation);
+  if (id < 0)
+    return -1;
+  return findPoint(id);
+}
+
+int ColumnStore::findSample(uint32_t point, uint32_t dateTime) const {
+  if (!samplesIndexed) {
+    // finalized, so the point's samples are together
+    for (uint32_t s = pointFirstSample[point]; s < pointFirstSample[point + 1];
+         s++) {
+      if (sampleDateTime[s] == dateTime)
+        return s;
+    }
+    return -1;
+  }
+  const auto &ids = sampleIds[shardOf(point)];
+  auto s = ids.find(sampleKey(point, dateTime));
+  if (s == ids.end())
+    return -1;
+  return s->second;
+}
+
+int ColumnStore::findDeterminand(uint32_t notation) const {
+  auto d = determinandIds.find(notation);
+  if (d == determinandIds.end())
+    return -1;
+  return d->second;
+}
+
+const vector<uint32_t> &ColumnStore::findPointsByLabel(uint32_t label) const {
+  static const vector<uint32_t> none;
+  auto l = labelPoints.find(label);
+  if (l == labelPoints.end())
+    return none;
+  return l->second;
+}
+
+ColumnStore::IdMap ColumnStore::mergeTables(const ColumnStore &other) {
+  IdMap ids;
+  // text other borrows stays borrowed
+  strings.keepAlive(other.strings);
+  auto &text = ids.text;
+  text.resize(other.strings.size());
+  for (size_t i = 0; i < text.size(); i++)
+    text[i] = strings.intern(other.strings.str(i), other.strings.isBorrowed(i));
+
+  auto &point = ids.point;
+  point.resize(other.pointCount());
+  for (size_t p = 0; p < point.size(); p++) {
+    uint32_t notation = text[other.pointNotation[p]];
+    int id = findPoint(notation);
+    point[p] = id >= 0 ? id
+                       : addPoint(notation, other.pointNorthing[p],
+                                  other.pointEasting[p],
+                                  text[other.pointLabel[p]]);
+  }
+
+  auto &determinand = ids.determinand;
+  determinand.resize(other.determinandCount());
+  for (size_t d = 0; d < determinand.size(); d++) {
+    uint32_t notation = text[other.determinandNotation[d]];
+    int id = findDeterminand(notation);
+    determinand[d] =
+        id >= 0 ? id
+                : addDeterminand(text[other.determinandLabel[d]],
+                                 text[other.determinandDefinition[d]],
+                                 notation,
+                                 text[other.determinandUnitLabel[d]]);
+  }
+  duplicateRows += other.duplicateRows;
+  return ids;
+}
+
+void ColumnStore::merge(const ColumnStore &other) {
+  auto ids = mergeTables(other);
+  if (other.sampleCount() > 0 && !samplesIndexed)
+    indexSamples();
+  const auto &text = ids.text;
+  const auto &point = ids.point;
+  const auto &determinand = ids.determinand;
+
+  vector<uint32_t> sample(other.sampleCount());
+  for (size_t s = 0; s < sample.size(); s++) {
+    uint32_t p = point[other.samplePoint[s]];
+    uint32_t dateTime = text[other.sampleDateTime[s]];
+    int id = findSample(p, dateTime);
+    sample[s] = id >= 0 ? id
+                        : addSample(p, other.sampleIsCompliance[s],
+                                    text[other.samplePurpose[s]], dateTime,
+                                    other.sampleTime[s],
+                                    text[other.sampleMaterialType[s]]);
+  }
+
+  reserveRows(rowCount() + other.rowCount());
+  for (size_t r = 0; r < other.rowCount(); r++) {
+    addRow(sample[other.rowSample[r]], determinand[other.rowDeterminand[r]],
+           other.rowResult[r]);
+  }
+}
+
+void ColumnStore::finalize(DuplicatePolicy duplicates) {
+  // samples grouped by point, keeping their ingest order within a point
+  auto samplePosition =
+      groupBy(samplePoint, pointCount(), pointFirstSample.values());
+  permute(samplePoint, samplePosition);
+  permute(sampleIsCompliance, samplePosition);
+  permute(samplePurpose, samplePosition);
+  permute(sampleDateTime, samplePosition);
+  permute(sampleTime, samplePosition);
+  permute(sampleMaterialType, samplePosition);
+
+  for (auto &sample : rowSample)
+    sample = samplePosition[sample];
+  for (auto &ids : sampleIds) {
+    for (auto &entry : ids)
+      entry.second = samplePosition[entry.second];
+  }
+
+  // rows grouped by sample, keeping file order within a sample
+  auto rowPosition =
+      groupBy(rowSample, sampleCount(), sampleFirstRow.values());
+  permute(rowPoint, rowPosition);
+  permute(rowSample, rowPosition);
+  permute(rowDeterminand, rowPosition);
+  permute(rowResult, rowPosition);
+
+  dropDuplicates(duplicates);
+}
+
+void ColumnStore::dropDuplicates(DuplicatePolicy policy) {
+  const uint32_t NONE = UINT32_MAX;
+  // the row of each determinand in the sample being looked at
+  vector<uint32_t> rowOf(determinandCount(), NONE);
+  // only filled in once there is something to drop
+  vector<bool> drop;
+  size_t dropped = 0;
+
+  for (uint32_t s = 0; s < sampleCount(); s++) {
+    uint32_t begin = sampleFirstRow[s], end = sampleFirstRow[s + 1];
+    for (uint32_t r = begin; r < end; r++) {
+      uint32_t &seen = rowOf[rowDeterminand[r]];
+      if (seen == NONE) {
+        seen = r;
+        continue;
+      }
+      if (policy == DuplicatePolicy::Error)
+        throw repeatedRow(samplePoint[s], sampleDateTime[s],
+                          rowDeterminand[r]);
+
+      if (drop.empty())
+        drop.assign(rowCount(), false);
+      if (policy == DuplicatePolicy::KeepFirst) {
+        drop[r] = true;
+      } else {
+        drop[seen] = true;
+        seen = r;
+      }
+      dropped++;
+    }
+    for (uint32_t r = begin; r < end; r++)
+      rowOf[rowDeterminand[r]] = NONE;
+  }
+  if (dropped == 0)
+    return;
+
+  uint32_t kept = 0;
+  for (uint32_t s = 0; s < sampleCount(); s++) {
+    uint32_t begin = sampleFirstRow[s], end = sampleFirstRow[s + 1];
+    sampleFirstRow[s] = kept;
+    for (uint32_t r = begin; r < end; r++) {
+      if (drop[r])
+        continue;
+      rowPoint[kept] = rowPoint[r];
+      rowSample[kept] = rowSample[r];
+      rowDeterminand[kept] = rowDeterminand[r];
+      rowResult[kept] = rowResult[r];
+      kept++;
+    }
+  }
+  sampleFirstRow[sampleCount()] = kept;
+  rowPoint.resize(kept);
+  rowSample.resize(kept);
+  rowDeterminand.resize(kept);
+  rowResult.resize(kept);
+  duplicateRows += dropped;
+}
+
+void ColumnStore::checkAppend(const ColumnStore &other) const {
+  // other's determinands as ours, the new ones numbered on after ours
+  vector<uint32_t> determinand(other.determinandCount());
+  for (uint32_t d = 0; d < determinand.size(); d++) {
+    int text = strings.find(other.strings.str(other.determinandNotation[d]));
+    int id = text < 0 ? -1 : findDeterminand(text);
+    determinand[d] = id >= 0 ? id : determinandCount() + d;
+  }
+  // other's samples as ours, the new ones numbered on after ours
+  vector<uint32_t> sample(other.sampleCount());
+  for (uint32_t s = 0; s < sample.size(); s++) {
+    sample[s] = sampleCount() + s;
+    int point =
+        findPoint(other.strings.str(other.pointNotation[other.samplePoint[s]]));
+    int dateTime = strings.find(other.strings.str(other.sampleDateTime[s]));
+    if (point >= 0 && dateTime >= 0) {
+      int id = findSample(point, dateTime);
+      if (id >= 0)
+        sample[s] = id;
+    }
+  }
+
+  // (sample, row), other's rows after ROWS; before finalize() our rows are
+  // not grouped by sample, so all of them go in
+  const uint32_t ROWS = UINT32_MAX / 2;
+  vector<pair<uint32_t, uint32_t>> rows;
+  if (sampleFirstRow.empty()) {
+    for (uint32_t r = 0; r < rowCount(); r++)
+      rows.push_back({rowSample[r], r});
+  }
+  for (uint32_t r = 0; r < other.rowCount(); r++)
+    rows.push_back({sample[other.rowSample[r]], ROWS + r});
+  stable_sort(rows.begin(), rows.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+
+  vector<bool> seen(determinandCount() + other.determinandCount(), false);
+  vector<uint32_t> marked;
+  for (size_t i = 0; i < rows.size();) {
+    uint32_t s = rows[i].first;
+    if (!sampleFirstRow.empty() && s < sampleCount()) {
+      for (uint32_t r = sampleFirstRow[s]; r < sampleFirstRow[s + 1]; r++) {
+        seen[rowDeterminand[r]] = true;
+        marked.push_back(rowDeterminand[r]);
+      }
+    }
+    for (; i < rows.size() && rows[i].first == s; i++) {
+      uint32_t r = rows[i].second;
+      if (r < ROWS) {
+        seen[rowDeterminand[r]] = true;
+        marked.push_back(rowDeterminand[r]);
+        continue;
+      }
+      r -= ROWS;
+      uint32_t d = determinand[other.rowDeterminand[r]];
+      if (seen[d]) {
+        uint32_t from = other.rowSample[r];
+        throw repeatedRow(
+            other.strings.str(other.pointNotation[other.samplePoint[from]]),
+            other.strings.str(other.sampleDateTime[from]),
+            other.strings.str(
+                other.determinandNotation[other.rowDeterminand[r]]));
+      }
+      seen[d] = true;
+      marked.push_back(d);
+    }
+    for (uint32_t d : marked)
+      seen[d] = false;
+    marked.clear();
+  }
+}
+
+void ColumnStore::append(const ColumnStore &other,
+                         DuplicatePolicy duplicates) {
+  // before anything is added, so a rejected append leaves the store as it was
+  if (duplicates == DuplicatePolicy::Error)
+    checkAppend(other);
+  // never finalized, so there is nothing to keep in place
+  if (sampleFirstRow.empty()) {
+    merge(other);
+    finalize(duplicates);
+    return;
+  }
+  const uint32_t NONE = UINT32_MAX;
+  uint32_t samples = sampleCount();
+  auto ids = mergeTables(other);
+  // new points have no samples yet
+  auto &firstSample = pointFirstSample.values();
+  firstSample.resize(pointCount() + 1, samples);
+
+  // other's samples -> ours, the new ones numbered on from `samples`
+  vector<uint32_t> sample(other.sampleCount());
+  vector<uint32_t> addedFrom; // other's sample of each new one
+  vector<uint32_t> addedPoint;
+  unordered_map<uint64_t, uint32_t> addedIds;
+  for (uint32_t s = 0; s < other.sampleCount(); s++) {
+    uint32_t p = ids.point[other.samplePoint[s]];
+    uint32_t dateTime = ids.text[other.sampleDateTime[s]];
+    int id = findSample(p, dateTime);
+    if (id < 0) {
+      auto [entry, added] = addedIds.try_emplace(sampleKey(p, dateTime),
+                                                 samples + addedFrom.size());
+      if (added) {
+        addedFrom.push_back(s);
+        addedPoint.push_back(p);
+      }
+      id = entry->second;
+    }
+    sample[s] = id;
+  }
+
+  // other's rows by our sample, each sample's in file order
+  vector<pair<uint32_t, uint32_t>> incoming(other.rowCount());
+  for (uint32_t r = 0; r < other.rowCount(); r++)
+    incoming[r] = {sample[other.rowSample[r]], r};
+  stable_sort(incoming.begin(), incoming.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+
+  // The rows each touched sample keeps, as in dropDuplicates(), its own
+  // first and then other's. A kept row is ours, or other's + NONE / 2.
+  const uint32_t OTHER = NONE / 2;
+  vector<uint32_t> kept;
+  unordered_map<uint32_t, pair<uint32_t, uint32_t>> keptOf;
+  vector<uint32_t> rowOf(determinandCount(), NONE);
+  vector<uint32_t> touched;
+  size_t dropped = 0;
+  uint32_t sampleStart = samples;
+  for (size_t i = 0; i < incoming.size();) {
+    uint32_t s = incoming[i].first;
+    touched.clear();
+    if (s < samples) {
+      for (uint32_t r = sampleFirstRow[s]; r < sampleFirstRow[s + 1]; r++)
+        touched.push_back(r);
+      sampleStart = min(sampleStart, s);
+    }
+    for (; i < incoming.size() && incoming[i].first == s; i++)
+      touched.push_back(OTHER + incoming[i].second);
+
+    auto determinandOf = [&](uint32_t row) {
+      return row < OTHER ? rowDeterminand[row]
+                         : ids.determinand[other.rowDeterminand[row - OTHER]];
+    };
+    for (uint32_t t = 0; t < touched.size(); t++) {
+      uint32_t &seen = rowOf[determinandOf(touched[t])];
+      if (seen == NONE) {
+        seen = t;
+        continue;
+      }
+      // never under Error, checkAppend() has looked already
+      if (duplicates == DuplicatePolicy::KeepLast)
+        seen = t;
+      dropped++;
+    }
+    uint32_t begin = kept.size();
+    for (uint32_t t = 0; t < touched.size(); t++) {
+      if (rowOf[determinandOf(touched[t])] == t)
+        kept.push_back(touched[t]);
+    }
+    for (uint32_t row : touched)
+      rowOf[determinandOf(row)] = NONE;
+    keptOf[s] = {begin, (uint32_t)kept.size()};
+  }
+  duplicateRows += dropped;
+
+  // new samples go after their point's, each point's in the order added
+  vector<uint32_t> added(addedFrom.size());
+  for (uint32_t a = 0; a < added.size(); a++) {
+    added[a] = a;
+    sampleStart = min(sampleStart, firstSample[addedPoint[a] + 1]);
+  }
+  stable_sort(added.begin(), added.end(), [&](uint32_t a, uint32_t b) {
+    return addedPoint[a] < addedPoint[b];
+  });
+  if (sampleStart == samples && added.empty())
+    return;
+
+  // our samples from sampleStart on, in their new order
+  vector<uint32_t> order;
+  size_t next = 0;
+  uint32_t shift = 0;
+  for (uint32_t p = 0; p < pointCount(); p++) {
+    uint32_t begin = firstSample[p], end = firstSample[p + 1];
+    firstSample[p] = begin + shift;
+    for (uint32_t s = max(begin, sampleStart); s < end; s++)
+      order.push_back(s);
+    for (; next < added.size() && addedPoint[added[next]] == p; next++) {
+      order.push_back(samples + added[next]);
+      shift++;
+    }
+  }
+  firstSample[pointCount()] = samples + shift;
+
+  // the moved samples and rows are written out afresh after the ones that
+  // stay in place
+  uint32_t rowStart = sampleFirstRow[sampleStart];
+  size_t moved = order.size();
+  vector<uint32_t> point(moved), purpose(moved), dateTime(moved),
+      materialType(moved), firstRow(moved + 1);
+  vector<uint8_t> isCompliance(moved);
+  vector<int64_t> time(moved);
+  vector<uint32_t> rowPoints, rowSamples, rowDeterminands;
+  vector<double> rowResults;
+  size_t rows = rowCount() - rowStart + other.rowCount();
+  rowPoints.reserve(rows);
+  rowSamples.reserve(rows);
+  rowDeterminands.reserve(rows);
+  rowResults.reserve(rows);
+  // our rows [begin, end) into sample `at`
+  const ColumnStore &ours = *this;
+  auto addOurs = [&](uint32_t begin, uint32_t end, uint32_t at) {
+    rowPoints.insert(rowPoints.end(), ours.rowPoint.begin() + begin,
+                     ours.rowPoint.begin() + end);
+    rowSamples.insert(rowSamples.end(), end - begin, at);
+    rowDeterminands.insert(rowDeterminands.end(),
+                           ours.rowDeterminand.begin() + begin,
+                           ours.rowDeterminand.begin() + end);
+    rowResults.insert(rowResults.end(), ours.rowResult.begin() + begin,
+                      ours.rowResult.begin() + end);
+  };
+
+  for (size_t i = 0; i < moved; i++) {
+    uint32_t s = order[i], at = sampleStart + i;
+    firstRow[i] = rowStart + rowSamples.size();
+    if (s < samples) {
+      point[i] = samplePoint[s];
+      isCompliance[i] = sampleIsCompliance[s];
+      purpose[i] = samplePurpose[s];
+      dateTime[i] = sampleDateTime[s];
+      time[i] = sampleTime[s];
+      materialType[i] = sampleMaterialType[s];
+    } else {
+      uint32_t from = addedFrom[s - samples];
+      point[i] = addedPoint[s - samples];
+      isCompliance[i] = other.sampleIsCompliance[from];
+      purpose[i] = ids.text[other.samplePurpose[from]];
+      dateTime[i] = ids.text[other.sampleDateTime[from]];
+      time[i] = other.sampleTime[from];
+      materialType[i] = ids.text[other.sampleMaterialType[from]];
+    }
+
+    auto k = keptOf.find(s);
+    if (k == keptOf.end()) {
+      // untouched, or new without rows
+      if (s < samples)
+        addOurs(ours.sampleFirstRow[s], ours.sampleFirstRow[s + 1], at);
+      continue;
+    }
+    for (uint32_t j = k->second.first; j < k->second.second; j++) {
+      if (kept[j] < OTHER) {
+        addOurs(kept[j], kept[j] + 1, at);
+        continue;
+      }
+      uint32_t r = kept[j] - OTHER;
+      rowPoints.push_back(point[i]);
+      rowSamples.push_back(at);
+      rowDeterminands.push_back(ids.determinand[other.rowDeterminand[r]]);
+      rowResults.push_back(other.rowResult[r]);
+    }
+  }
+  firstRow[moved] = rowStart + rowSamples.size();
+
+  auto place = [](auto &column, size_t start, const auto &values) {
+    auto &out = column.values();
+    out.resize(start);
+    out.insert(out.end(), values.begin(), values.end());
+  };
+  place(samplePoint, sampleStart, point);
+  place(sampleIsCompliance, sampleStart, isCompliance);
+  place(samplePurpose, sampleStart, purpose);
+  place(sampleDateTime, sampleStart, dateTime);
+  place(sampleTime, sampleStart, time);
+  place(sampleMaterialType, sampleStart, materialType);
+  place(sampleFirstRow, sampleStart, firstRow);
+  place(rowPoint, rowStart, rowPoints);
+  place(rowSample, rowStart, rowSamples);
+  place(rowDeterminand, rowStart, rowDeterminands);
+  place(rowResult, rowStart, rowResults);
+
+  // Samples that moved are stale in the index. Updating them would cost
+  // more than the move; findSample() manages without while finalized.
+  if (!added.empty() && samplesIndexed) {
+    for (auto &shard : sampleIds)
+      shard = {};
+    samplesIndexed = false;
+  }
+}
+
+ColumnStore ColumnStore::mergeAll(vector<ColumnStore> &parts,
+                                  DuplicatePolicy duplicates, size_t threads) {
+  ColumnStore store;
+  size_t n = parts.size();
+  if (n == 1) {
+    store = std::move(parts[0]);
+    parts.clear();
+    store.finalize(duplicates);
+    return store;
+  }
+  vector<IdMap> ids;
+  for (const auto &part : parts)
+    ids.push_back(store.mergeTables(part));
+
+  // each worker owns the points of every threads-th shard
+  size_t workers = max<size_t>(1, min(threads, SAMPLE_SHARDS));
+  auto owner = [&](uint32_t point) { return shardOf(point) % workers; };
+
+  // Samples are numbered per worker first, in the order merge() would add
+  // them. `local` maps every part's samples to those numbers; each entry
+  // is written by the one worker that owns the sample's point.
+  struct Shard {
+    vector<pair<uint32_t, uint32_t>> first; // (part, sample) seen first
+    vector<uint32_t> point;
+    vector<uint32_t> rows;
+    vector<uint32_t> final; // position once grouped by point
+    uint32_t repeat = UINT32_MAX; // first repeated row, for Error
+    size_t dropped = 0;
+  };
+  vector<Shard> shards(workers);
+  vector<vector<uint32_t>> local(n);
+  for (size_t i = 0; i < n; i++)
+    local[i].resize(parts[i].sampleCount());
+  vector<uint32_t> pointSamples(store.pointCount(), 0);
+
+  runParallel(workers, [&](size_t w) {
+    auto &shard = shards[w];
+    for (size_t i = 0; i < n; i++) {
+      const auto &part = parts[i];
+      for (uint32_t s = 0; s < part.sampleCount(); s++) {
+        uint32_t p = ids[i].point[part.samplePoint[s]];
+        if (owner(p) != w)
+          continue;
+        uint64_t key = sampleKey(p, ids[i].text[part.sampleDateTime[s]]);
+        auto [entry, added] =
+            store.sampleIds[shardOf(p)].try_emplace(key, shard.point.size());
+        if (added) {
+          shard.first.push_back({i, s});
+          shard.point.push_back(p);
+          shard.rows.push_back(0);
+          pointSamples[p]++;
+        }
+        local[i][s] = entry->second;
+      }
+      for (size_t r = 0; r < part.rowCount(); r++) {
+        if (owner(ids[i].point[part.rowPoint[r]]) == w)
+          shard.rows[local[i][part.rowSample[r]]]++;
+      }
+    }
+  });
+
+  // samples grouped by point, each point's in the order they were added
+  auto &firstSample = store.pointFirstSample;
+  firstSample.assign(store.pointCount() + 1, 0);
+  for (size_t p = 0; p < store.pointCount(); p++)
+    firstSample[p + 1] = firstSample[p] + pointSamples[p];
+  size_t samples = firstSample.back();
+  store.samplePoint.resize(samples);
+  store.sampleIsCompliance.resize(samples);
+  store.samplePurpose.resize(samples);
+  store.sampleDateTime.resize(samples);
+  store.sampleTime.resize(samples);
+  store.sampleMaterialType.resize(samples);
+  vector<uint32_t> sampleRows(samples + 1, 0);
+  vector<uint32_t> nextSample(firstSample.begin(), firstSample.end() - 1);
+
+  runParallel(workers, [&](size_t w) {
+    auto &shard = shards[w];
+    shard.final.resize(shard.point.size());
+    for (size_t l = 0; l < shard.point.size(); l++) {
+      uint32_t f = nextSample[shard.point[l]]++;
+      shard.final[l] = f;
+      auto [i, s] = shard.first[l];
+      const auto &part = parts[i];
+      const auto &text = ids[i].text;
+      store.samplePoint[f] = shard.point[l];
+      store.sampleIsCompliance[f] = part.sampleIsCompliance[s];
+      store.samplePurpose[f] = text[part.samplePurpose[s]];
+      store.sampleDateTime[f] = text[part.sampleDateTime[s]];
+      store.sampleTime[f] = part.sampleTime[s];
+      store.sampleMaterialType[f] = text[part.sampleMaterialType[s]];
+      sampleRows[f] = shard.rows[l];
+    }
+    for (size_t k = w; k < SAMPLE_SHARDS; k += workers) {
+      for (auto &entry : store.sampleIds[k])
+        entry.second = shard.final[entry.second];
+    }
+  });
+
+  // rows grouped by sample, each sample's in file order
+  auto &firstRow = store.sampleFirstRow;
+  firstRow.assign(samples + 1, 0);
+  for (size_t s = 0; s < samples; s++)
+    firstRow[s + 1] = firstRow[s] + sampleRows[s];
+  size_t rows = firstRow.back();
+  store.rowPoint.resize(rows);
+  store.rowSample.resize(rows);
+  store.rowDeterminand.resize(rows);
+  store.rowResult.resize(rows);
+  auto &nextRow = sampleRows;
+  copy(firstRow.begin(), firstRow.end(), nextRow.begin());
+
+  runParallel(workers, [&](size_t w) {
+    const auto &shard = shards[w];
+    for (size_t i = 0; i < n; i++) {
+      const auto &part = parts[i];
+      for (size_t r = 0; r < part.rowCount(); r++) {
+        uint32_t p = ids[i].point[part.rowPoint[r]];
+        if (owner(p) != w)
+          continue;
+        uint32_t f = shard.final[local[i][part.rowSample[r]]];
+        uint32_t at = nextRow[f]++;
+        store.rowPoint[at] = p;
+        store.rowSample[at] = f;
+        store.rowDeterminand[at] = ids[i].determinand[part.rowDeterminand[r]];
+        store.rowResult[at] = part.rowResult[r];
+      }
+    }
+  });
+  parts.clear();
+
+  // Repeated rows, found per sample as in dropDuplicates(). keep(s, visit)
+  // calls visit(row) for each row of sample s the policy keeps, in order,
+  // and returns the first repeated row (UINT32_MAX if there is none).
+  const uint32_t NONE = UINT32_MAX;
+  auto keep = [&](uint32_t s, vector<uint32_t> &rowOf, auto visit) {
+    uint32_t begin = firstRow[s], end = firstRow[s + 1];
+    uint32_t repeat = NONE;
+    for (uint32_t r = begin; r < end; r++) {
+      uint32_t &seen = rowOf[store.rowDeterminand[r]];
+      if (seen != NONE && repeat == NONE)
+        repeat = r;
+      if (seen == NONE || duplicates == DuplicatePolicy::KeepLast)
+        seen = r;
+    }
+    for (uint32_t r = begin; r < end; r++) {
+      // KeepFirst keeps the row it saw first, KeepLast the one it saw last
+      if (rowOf[store.rowDeterminand[r]] == r)
+        visit(r);
+    }
+    for (uint32_t r = begin; r < end; r++)
+      rowOf[store.rowDeterminand[r]] = NONE;
+    return repeat;
+  };
+  // each worker's points in turn, so its samples in ascending order
+  auto forSamples = [&](size_t w, auto visit) {
+    for (uint32_t p = 0; p < store.pointCount(); p++) {
+      if (owner(p) != w)
+        continue;
+      for (uint32_t s = firstSample[p]; s < firstSample[p + 1]; s++)
+        visit(s);
+    }
+  };
+
+  vector<uint32_t> keptRows(samples + 1, 0);
+  runParallel(workers, [&](size_t w) {
+    auto &shard = shards[w];
+    vector<uint32_t> rowOf(store.determinandCount(), NONE);
+    forSamples(w, [&](uint32_t s) {
+      uint32_t repeat = keep(s, rowOf, [&](uint32_t) { keptRows[s]++; });
+      if (repeat != NONE && shard.repeat == NONE)
+        shard.repeat = repeat;
+      shard.dropped += firstRow[s + 1] - firstRow[s] - keptRows[s];
+    });
+  });
+
+  size_t dropped = 0;
+  uint32_t repeat = NONE;
+  for (const auto &shard : shards) {
+    dropped += shard.dropped;
+    repeat = min(repeat, shard.repeat);
+  }
+  if (duplicates == DuplicatePolicy::Error && repeat != NONE) {
+    uint32_t s = store.rowSample[repeat];
+    throw store.repeatedRow(store.samplePoint[s], store.sampleDateTime[s],
+                            store.rowDeterminand[repeat]);
+  }
+  store.duplicateRows += dropped;
+  if (dropped == 0)
+    return store;
+
+  // the kept rows move down into fresh columns
+  vector<uint32_t> keptFirst(samples + 1, 0);
+  for (size_t s = 0; s < samples; s++)
+    keptFirst[s + 1] = keptFirst[s] + keptRows[s];
+  size_t kept = keptFirst.back();
+  vector<uint32_t> rowPoint(kept), rowSample(kept), rowDeterminand(kept);
+  vector<double> rowResult(kept);
+  runParallel(workers, [&](size_t w) {
+    vector<uint32_t> rowOf(store.determinandCount(), NONE);
+    forSamples(w, [&](uint32_t s) {
+      uint32_t at = keptFirst[s];
+      keep(s, rowOf, [&](uint32_t r) {
+        rowPoint[at] = store.rowPoint[r];
+        rowSample[at] = store.rowSample[r];
+        rowDeterminand[at] = store.rowDeterminand[r];
+        rowResult[at] = store.rowResult[r];
+        at++;
+      });
+    });
+  });
+  store.rowPoint.values().swap(rowPoint);
+  store.rowSample.values().swap(rowSample);
+  store.rowDeterminand.values().swap(rowDeterminand);
+  store.rowResult.values().swap(rowResult);
+  firstRow.values().swap(keptFirst);
+  return store;
+}
+
+runtime_error ColumnStore::repeatedRow(uint32_t point, uint32_t dateTime,
+                                       uint32_t determinand) const {
+  return repeatedRow(strings.str(pointNotation[point]), strings.str(dateTime),
+                     strings.str(determinandNotation[determinand]));
+}
+
+runtime_error ColumnStore::repeatedRow(string_view point, string_view dateTime,
+                                       string_view determinand) {
+  return runtime_error("Repeated row: sampling point " + string(point) +
+                       " at " + string(dateTime) + ", determinand " +
+                       string(determinand));
+}
+
+void ColumnStore::rebuildIndexes() {
+  pointIds.clear();
+  determinandIds.clear();
+  for (auto &ids : sampleIds)
+    ids.clear();
+  labelPoints.clear();
+
+  for (uint32_t p = 0; p < pointCount(); p++) {
+    pointIds[pointNotation[p]] = p;
+    labelPoints[pointLabel[p]].push_back(p);
+  }
+  for (uint32_t d = 0; d < determinandCount(); d++)
+    determinandIds[determinandNotation[d]] = d;
+  // left to indexSamples(), findSample() manages without
+  samplesIndexed = false;
+}
+
+void ColumnStore::indexSamples() {
+  for (auto &ids : sampleIds)
+    ids.reserve(sampleCount() / SAMPLE_SHARDS);
+  for (uint32_t s = 0; s < sampleCount(); s++)
+    sampleIds[shardOf(samplePoint[s])]
+             [sampleKey(samplePoint[s], sampleDateTime[s])] = s;
+  samplesIndexed = true;
+}
+
+void ColumnStore::clear() { *this = ColumnStore(); }
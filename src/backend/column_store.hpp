@@ -0,0 +1,169 @@
+// Columnar storage behind WaterDataset
+
+#pragma once
+
+#include "column_data.hpp"
+#include "string_pool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Every CSV row becomes one entry in the row columns (point, sample,
+ * determinand, result). Sampling points, samples and determinands are kept
+ * once each in their own tables and referenced by index. Text fields are
+ * stored as ids into the StringPool.
+ *
+ * finalize() reorders the tables so that the samples of a point and the rows
+ * of a sample are contiguous. SamplingPoint, Sample and Determinand are then
+ * just (store, index) views over these ranges.
+ *
+ * A sample is already keyed on (point, datetime), so a repeated row is one
+ * whose determinand its sample already has. Overlapping exports that are
+ * loaded together produce these. Once a sample's rows are contiguous they
+ * are found in one pass per sample, with a table indexed by determinand id,
+ * and finalize() handles them by its DuplicatePolicy.
+ *
+ * The sample index is split into SAMPLE_SHARDS maps by sampling point, so
+ * mergeAll() can build the samples and rows of many partial stores on one
+ * thread per group of shards. Each thread owns its points' samples, their
+ * rows and their index entries, and writes them straight to their final
+ * grouped positions. No two threads touch the same entry, so no locks are
+ * needed. Only the text, points and determinands, of which there are few,
+ * are matched up on one thread.
+ *
+ * The columns can borrow their values from a mapped snapshot (see
+ * ColumnData). Such a store is finalized, so findSample() can look through
+ * its point's samples instead; the sample index, which costs as much to
+ * build as everything else together, is only built once samples are added.
+ */
+enum class DuplicatePolicy {
+  KeepFirst,
+  KeepLast,
+  // finalize() throws std::runtime_error naming the first repeated row
+  Error,
+};
+
+class ColumnStore {
+public:
+  // sampleTime of a sample whose date could not be parsed
+  static constexpr int64_t NO_TIME = INT64_MIN;
+
+  // ingest, text arguments are StringPool ids
+  uint32_t addPoint(uint32_t notation, int northing, int easting,
+                    uint32_t label);
+  uint32_t addSample(uint32_t point, bool isComplianceSample, uint32_t purpose,
+                     uint32_t dateTime, int64_t time,
+                     uint32_t sampledMaterialType);
+  uint32_t addDeterminand(uint32_t label, uint32_t definition,
+                          uint32_t notation, uint32_t unitLabel);
+  void addRow(uint32_t sample, uint32_t determinand, double result);
+  void reserveRows(size_t rows);
+
+  int findPoint(uint32_t notation) const;
+  int findPoint(std::string_view notation) const;
+  int findSample(uint32_t point, uint32_t dateTime) const;
+  int findDeterminand(uint32_t notation) const;
+  // labels are not unique, every point carrying the label is returned
+  const std::vector<uint32_t> &findPointsByLabel(uint32_t label) const;
+
+  // appends another store's points, samples and rows, matching points,
+  // samples and determinands that both contain; finalize() afterwards
+  void merge(const ColumnStore &other);
+  // groups samples by point and rows by sample and drops repeated rows, must
+  // be called after ingest
+  void finalize(DuplicatePolicy duplicates = DuplicatePolicy::KeepFirst);
+  // The same store as merge(other) and then finalize(), for a finalized
+  // store gaining a few rows. Only the samples and rows from the first one
+  // other changes on are moved, and only the samples other touches are
+  // searched for repeated rows. Under DuplicatePolicy::Error a repeat is
+  // found before anything is added, so a throwing append changes nothing.
+  void append(const ColumnStore &other, DuplicatePolicy duplicates);
+  // The same store as merge()-ing every part into an empty one in order and
+  // then finalize(), built on up to `threads` threads. Leaves `parts` empty.
+  static ColumnStore mergeAll(std::vector<ColumnStore> &parts,
+                              DuplicatePolicy duplicates, size_t threads);
+  // refills the lookup indexes from the tables, for columns that were
+  // filled directly (e.g. from a snapshot), which must be finalized
+  void rebuildIndexes();
+  void clear();
+
+  size_t pointCount() const { return pointNotation.size(); }
+  size_t sampleCount() const { return samplePoint.size(); }
+  size_t determinandCount() const { return determinandNotation.size(); }
+  size_t rowCount() const { return rowSample.size(); }
+
+  // row columns
+  ColumnData<uint32_t> rowPoint;
+  ColumnData<uint32_t> rowSample;
+  ColumnData<uint32_t> rowDeterminand;
+  ColumnData<double> rowResult;
+
+  StringPool strings;
+  // rows finalize() has dropped as repeats, including those of merged stores
+  size_t duplicateRows = 0;
+
+  // sampling point table
+  ColumnData<uint32_t> pointNotation;
+  ColumnData<uint32_t> pointLabel;
+  ColumnData<int> pointNorthing;
+  ColumnData<int> pointEasting;
+  ColumnData<uint32_t> pointFirstSample;
+
+  // sample table
+  ColumnData<uint32_t> samplePoint;
+  ColumnData<uint8_t> sampleIsCompliance;
+  ColumnData<uint32_t> samplePurpose;
+  ColumnData<uint32_t> sampleDateTime;
+  ColumnData<int64_t> sampleTime; // ms since the epoch, or NO_TIME
+  ColumnData<uint32_t> sampleMaterialType;
+  ColumnData<uint32_t> sampleFirstRow;
+
+  // determinand table
+  ColumnData<uint32_t> determinandLabel;
+  ColumnData<uint32_t> determinandDefinition;
+  ColumnData<uint32_t> determinandNotation;
+  ColumnData<uint32_t> determinandUnitLabel;
+
+private:
+  static constexpr size_t SAMPLE_SHARDS = 64;
+
+  // other's text, point and determinand ids -> ours
+  struct IdMap {
+    std::vector<uint32_t> text, point, determinand;
+  };
+
+  void dropDuplicates(DuplicatePolicy policy);
+  // adds other's text, points and determinands that are new to us
+  IdMap mergeTables(const ColumnStore &other);
+  // dateTime is a string id
+  std::runtime_error repeatedRow(uint32_t point, uint32_t dateTime,
+                                 uint32_t determinand) const;
+  static std::runtime_error repeatedRow(std::string_view point,
+                                        std::string_view dateTime,
+                                        std::string_view determinand);
+  // throws repeatedRow() for the first row of other's that repeats one of
+  // ours or an earlier one of its own, without changing anything
+  void checkAppend(const ColumnStore &other) const;
+  // fills sampleIds, if rebuildIndexes() left it empty
+  void indexSamples();
+
+  static uint64_t sampleKey(uint32_t point, uint32_t dateTime) {
+    return (uint64_t)point << 32 | dateTime;
+  }
+  static size_t shardOf(uint32_t point) { return point % SAMPLE_SHARDS; }
+
+  // keyed by the notation's string id
+  std::unordered_map<uint32_t, uint32_t> pointIds;
+  std::unordered_map<uint32_t, uint32_t> determinandIds;
+  // keyed by sampleKey(point, dateTime string id), one map per shardOf(point)
+  std::vector<std::unordered_map<uint64_t, uint32_t>> sampleIds =
+      std::vector<std::unordered_map<uint64_t, uint32_t>>(SAMPLE_SHARDS);
+  // false while sampleIds is left empty and the samples are grouped by point
+  bool samplesIndexed = true;
+  // keyed by the label's string id
+  std::unordered_map<uint32_t, std::vector<uint32_t>> labelPoints;
+};
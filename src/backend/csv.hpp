@@ -45,6 +45,22 @@ SOFTWARE.
 #include <string>
 #include <vector>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define CSV_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#if defined(__GNUC__)
+#define CSV_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CSV_TARGET_AVX2
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CSV_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
 /* Copyright 2017 https://github.com/mandreyel
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy of this
@@ -1802,6 +1818,7 @@ using shared_ummap_sink = basic_shared_mmap_sink<unsigned char>;
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <condition_variable>
 #include <deque>
 #include <fstream>
@@ -5470,10 +5487,11 @@ namespace csv {
             CSVFieldList(CSVFieldList&& other) :
                 _single_buffer_capacity(other._single_buffer_capacity) {
 
-                for (auto&& buffer : other.buffers) {
-                    this->buffers.emplace_back(std::move(buffer));
+                for (size_t i = 0; i < MAX_GROUPS; i++) {
+                    this->groups[i] = std::move(other.groups[i]);
                 }
 
+                _buffer_count = other._buffer_count;
                 _current_buffer_size = other._current_buffer_size;
                 _back = other._back;
             }
@@ -5489,7 +5507,7 @@ namespace csv {
             }
 
             size_t size() const noexcept {
-                return this->_current_buffer_size + ((this->buffers.size() - 1) * this->_single_buffer_capacity);
+                return this->_current_buffer_size + ((this->_buffer_count - 1) * this->_single_buffer_capacity);
             }
 
             RawCSVField& operator[](size_t n) const;
@@ -5498,13 +5516,18 @@ namespace csv {
             const size_t _single_buffer_capacity;
 
             /**
-             * Prefer std::deque over std::vector because it does not
-             * reallocate upon expansion, allowing pointers to its members
-             * to remain valid & avoiding potential race conditions when 
-             * CSVFieldList is accesssed simulatenously by a reading thread and
-             * a writing thread
+             * Buffers are kept in groups of FIRST_GROUP, 2 * FIRST_GROUP, ...
+             * pointers that are never moved once allocated, so a reading thread
+             * can index fields while the writing thread adds buffers. (A
+             * std::deque does not move its elements either, but it does
+             * reallocate the map it indexes them through.)
              */
-            std::deque<std::unique_ptr<RawCSVField[]>> buffers = {};
+            static constexpr size_t FIRST_GROUP = 256;
+            static constexpr size_t MAX_GROUPS = 48;
+            std::unique_ptr<std::unique_ptr<RawCSVField[]>[]> groups[MAX_GROUPS];
+
+            /** Number of buffers allocated */
+            size_t _buffer_count = 0;
 
             /** Number of items in the current buffer */
             size_t _current_buffer_size = 0;
@@ -5514,6 +5537,9 @@ namespace csv {
 
             /** Allocate a new page of memory */
             void allocate();
+
+            /** The slot holding the page_no-th buffer */
+            std::unique_ptr<RawCSVField[]>& buffer(size_t page_no) const;
         };
 
         /** A class for storing raw CSV data and associated metadata */
@@ -5918,6 +5944,143 @@ namespace csv {
             return make_ws_flags(flags.data(), flags.size());
         }
 
+        /** @name Vectorized search for special characters */
+        ///@{
+        /** Returns the first position in [pos, size) holding one of the four
+         *  `chars`, or the start of the tail too short for a full vector.
+         */
+        using FindAnyFn = size_t (*)(const char* data, size_t pos, size_t size, const char* chars);
+
+        inline size_t find_any_none(const char*, size_t pos, size_t, const char*) noexcept {
+            return pos;
+        }
+
+        inline int first_bit(uint64_t mask) noexcept {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward64(&index, mask);
+            return (int)index;
+#else
+            return __builtin_ctzll(mask);
+#endif
+        }
+
+#if defined(CSV_SIMD_X86)
+        inline size_t find_any_sse2(const char* data, size_t pos, size_t size, const char* chars) noexcept {
+            const __m128i c0 = _mm_set1_epi8(chars[0]), c1 = _mm_set1_epi8(chars[1]),
+                c2 = _mm_set1_epi8(chars[2]), c3 = _mm_set1_epi8(chars[3]);
+
+            for (; pos + 16 <= size; pos += 16) {
+                __m128i in = _mm_loadu_si128((const __m128i*)(data + pos));
+                __m128i hits = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(in, c0), _mm_cmpeq_epi8(in, c1)),
+                    _mm_or_si128(_mm_cmpeq_epi8(in, c2), _mm_cmpeq_epi8(in, c3)));
+                unsigned mask = (unsigned)_mm_movemask_epi8(hits);
+                if (mask) return pos + first_bit(mask);
+            }
+
+            return pos;
+        }
+
+        CSV_TARGET_AVX2 inline size_t find_any_avx2(const char* data, size_t pos, size_t size, const char* chars) noexcept {
+            const __m256i c0 = _mm256_set1_epi8(chars[0]), c1 = _mm256_set1_epi8(chars[1]),
+                c2 = _mm256_set1_epi8(chars[2]), c3 = _mm256_set1_epi8(chars[3]);
+
+            for (; pos + 32 <= size; pos += 32) {
+                __m256i in = _mm256_loadu_si256((const __m256i*)(data + pos));
+                __m256i hits = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(in, c0), _mm256_cmpeq_epi8(in, c1)),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(in, c2), _mm256_cmpeq_epi8(in, c3)));
+                unsigned mask = (unsigned)_mm256_movemask_epi8(hits);
+                if (mask) return pos + first_bit(mask);
+            }
+
+            return find_any_sse2(data, pos, size, chars);
+        }
+#elif defined(CSV_SIMD_NEON)
+        inline size_t find_any_neon(const char* data, size_t pos, size_t size, const char* chars) noexcept {
+            const uint8x16_t c0 = vdupq_n_u8((uint8_t)chars[0]), c1 = vdupq_n_u8((uint8_t)chars[1]),
+                c2 = vdupq_n_u8((uint8_t)chars[2]), c3 = vdupq_n_u8((uint8_t)chars[3]);
+
+            for (; pos + 16 <= size; pos += 16) {
+                uint8x16_t in = vld1q_u8((const uint8_t*)(data + pos));
+                uint8x16_t hits = vorrq_u8(
+                    vorrq_u8(vceqq_u8(in, c0), vceqq_u8(in, c1)),
+                    vorrq_u8(vceqq_u8(in, c2), vceqq_u8(in, c3)));
+                // four bits per byte, there is no movemask on NEON
+                uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(
+                    vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+                if (mask) return pos + (first_bit(mask) >> 2);
+            }
+
+            return pos;
+        }
+#endif
+
+        /** The widest implementation this CPU supports, picked once */
+        inline FindAnyFn find_any_impl() noexcept {
+            static const FindAnyFn impl = [] {
+#if defined(CSV_SIMD_X86)
+#if defined(__GNUC__)
+                if (__builtin_cpu_supports("avx2"))
+                    return (FindAnyFn)find_any_avx2;
+#endif
+                return (FindAnyFn)find_any_sse2;
+#elif defined(CSV_SIMD_NEON)
+                return (FindAnyFn)find_any_neon;
+#else
+                return (FindAnyFn)find_any_none;
+#endif
+            }();
+
+            return impl;
+        }
+
+        /** Skips runs of bytes that have no meaning to the parser.
+         *
+         *  Outside quotes the special bytes are the delimiter, the quote and
+         *  the newlines; inside quotes only the quote is. With at most four of
+         *  them the scan is vectorized, the rest (and any other dialect) goes
+         *  through the flag table a byte at a time.
+         */
+        class SpecialScanner {
+        public:
+            SpecialScanner() = default;
+
+            SpecialScanner(const ParseFlagMap& flags, bool quote_escape) {
+                int count = 0;
+                for (int i = 0; i < 256; i++) {
+                    if (quote_escape_flag(flags[i], quote_escape) == ParseFlags::NOT_SPECIAL)
+                        continue;
+
+                    _special[i] = true;
+                    if (count < 4) _chars[count] = char(i - 128);
+                    count++;
+                }
+
+                if (count == 0 || count > 4) return;
+                // unused slots repeat a real special character
+                for (int i = count; i < 4; i++)
+                    _chars[i] = _chars[0];
+                _find_any = find_any_impl();
+            }
+
+            /** First position in [pos, size) holding a special byte, or size */
+            size_t find(const char* data, size_t pos, size_t size) const noexcept {
+                pos = _find_any(data, pos, size, _chars);
+                while (pos < size && !_special[data[pos] + 128])
+                    pos++;
+
+                return pos;
+            }
+
+        private:
+            std::array<bool, 256> _special = {};
+            char _chars[4] = {};
+            FindAnyFn _find_any = find_any_none;
+        };
+        ///@}
+
         CSV_INLINE size_t get_file_size(csv::string_view filename);
 
         CSV_INLINE std::string get_csv_head(csv::string_view filename);
@@ -5925,104 +6088,192 @@ namespace csv {
         /** Read the first 500KB of a CSV file */
         CSV_INLINE std::string get_csv_head(csv::string_view filename, size_t file_size);
 
-        /** A std::deque wrapper which allows multiple read and write threads to concurrently
-         *  access it along with providing read threads the ability to wait for the deque
-         *  to become populated
+        /** Hands parsed rows from the read_csv() thread to the reading thread
+         *  a batch at a time.
+         *
+         *  The producer fills a private batch without locking and publishes
+         *  it onto a single-producer/single-consumer linked list of batches.
+         *  The consumer takes a whole batch off the list and pops rows out of
+         *  it without locking. The mutex and condition variable are only used
+         *  when the consumer has run dry and has to sleep.
+         *
+         *  @note The queue is not bounded: CSVReader::initial_read() parses a
+         *        whole chunk before anything consumes it, so a full queue
+         *        would deadlock. A chunk is at most ITERATION_CHUNK_SIZE bytes
+         *        of input, which bounds the queue anyway.
          */
         template<typename T>
-        class ThreadSafeDeque {
+        class BatchQueue {
+            struct Batch {
+                std::vector<T> rows;
+                std::atomic<Batch*> next{ nullptr };
+            };
+
         public:
-            ThreadSafeDeque(size_t notify_size = 100) : _notify_size(notify_size) {};
-            ThreadSafeDeque(const ThreadSafeDeque& other) {
-                this->data = other.data;
-                this->_notify_size = other._notify_size;
+            BatchQueue(size_t batch_size = 256) : _batch_size(batch_size) {
+                this->_head = this->_tail = new Batch();
             }
 
-            ThreadSafeDeque(const std::deque<T>& source) : ThreadSafeDeque() {
-                this->data = source;
-            }
+            BatchQueue(const BatchQueue&) = delete;
+            BatchQueue& operator=(const BatchQueue&) = delete;
 
-            void clear() noexcept { this->data.clear(); }
+            ~BatchQueue() {
+                while (this->_head) {
+                    Batch* next = this->_head->next.load(std::memory_order_relaxed);
+                    delete this->_head;
+                    this->_head = next;
+                }
+            }
 
-            bool empty() const noexcept {
-                return this->data.empty();
+            /** @name Producer side */
+            ///@{
+            void push_back(T&& item) {
+                this->_pending.push_back(std::move(item));
+                if (this->_pending.size() >= this->_batch_size) {
+                    this->flush();
+                }
             }
 
-            T& front() noexcept {
-                return this->data.front();
+            /** Publish the rows pushed since the last full batch */
+            void flush() {
+                if (this->_pending.empty()) {
+                    return;
+                }
+
+                Batch* batch = new Batch();
+                batch->rows.swap(this->_pending);
+                this->_pending.reserve(this->_batch_size);
+                this->_tail->next.store(batch);
+                this->_tail = batch;
+
+                if (this->_waiting.load()) {
+                    std::lock_guard<std::mutex> lock{ this->_lock };
+                    this->_cond.notify_all();
+                }
             }
 
-            T& operator[](size_t n) {
-                return this->data[n];
+            /** Tell listeners that this queue is actively being pushed to */
+            void notify_all() {
+                std::lock_guard<std::mutex> lock{ this->_lock };
+                this->_is_waitable.store(true);
+                this->_cond.notify_all();
             }
 
-            void push_back(T&& item) {
+            /** Publish what is left and tell all listeners to stop */
+            void kill_all() {
+                this->flush();
                 std::lock_guard<std::mutex> lock{ this->_lock };
-                this->data.push_back(std::move(item));
+                this->_is_waitable.store(false);
+                this->_cond.notify_all();
+            }
+            ///@}
 
-                if (this->size() >= _notify_size) {
-                    this->_cond.notify_all();
-                }
+            /** @name Consumer side */
+            ///@{
+            bool empty() noexcept {
+                return this->_pos == this->_current.size() && !this->take();
+            }
+
+            T& front() noexcept {
+                this->empty();
+                return this->_current[this->_pos];
             }
 
             T pop_front() noexcept {
-                std::lock_guard<std::mutex> lock{ this->_lock };
-                T item = std::move(data.front());
-                data.pop_front();
-                return item;
+                this->empty();
+                return std::move(this->_current[this->_pos++]);
             }
 
-            size_t size() const noexcept { return this->data.size(); }
+            /** Number of published rows not yet popped, gathering them all
+             *  into the current batch. Only for single-threaded use.
+             */
+            size_t size() noexcept {
+                this->gather();
+                return this->_current.size() - this->_pos;
+            }
 
-            /** Returns true if a thread is actively pushing items to this deque */
-            constexpr bool is_waitable() const noexcept { return this->_is_waitable; }
+            /** Published row `n` past the front. Only for single-threaded use. */
+            T& operator[](size_t n) {
+                this->gather();
+                return this->_current[this->_pos + n];
+            }
+
+            void clear() noexcept {
+                this->gather();
+                this->_current.clear();
+                this->_pos = 0;
+            }
 
-            /** Wait for an item to become available */
+            /** Returns true if a thread is actively pushing items to this queue */
+            bool is_waitable() const noexcept { return this->_is_waitable.load(); }
+
+            /** Wait for a batch to become available */
             void wait() {
                 if (!is_waitable()) {
                     return;
                 }
 
                 std::unique_lock<std::mutex> lock{ this->_lock };
-                this->_cond.wait(lock, [this] { return this->size() >= _notify_size || !this->is_waitable(); });
-                lock.unlock();
+                this->_waiting.store(true);
+                this->_cond.wait(lock, [this] {
+                    return this->_head->next.load() != nullptr || !this->is_waitable();
+                });
+                this->_waiting.store(false);
             }
+            ///@}
 
-            typename std::deque<T>::iterator begin() noexcept {
-                return this->data.begin();
-            }
+        private:
+            /** Make the next published batch current, false if there is none */
+            bool take() noexcept {
+                Batch* next = this->_head->next.load(std::memory_order_acquire);
+                if (!next) {
+                    return false;
+                }
 
-            typename std::deque<T>::iterator end() noexcept {
-                return this->data.end();
+                delete this->_head;
+                this->_head = next;
+                this->_current.swap(next->rows);
+                next->rows.clear();
+                this->_pos = 0;
+                return true;
             }
 
-            /** Tell listeners that this deque is actively being pushed to */
-            void notify_all() {
-                std::unique_lock<std::mutex> lock{ this->_lock };
-                this->_is_waitable = true;
-                this->_cond.notify_all();
+            void gather() {
+                std::vector<T> rows(
+                    std::make_move_iterator(this->_current.begin() + this->_pos),
+                    std::make_move_iterator(this->_current.end()));
+                while (this->take()) {
+                    rows.insert(rows.end(),
+                        std::make_move_iterator(this->_current.begin()),
+                        std::make_move_iterator(this->_current.end()));
+                }
+                this->_current.swap(rows);
+                this->_pos = 0;
             }
 
-            /** Tell all listeners to stop */
-            void kill_all() {
-                std::unique_lock<std::mutex> lock{ this->_lock };
-                this->_is_waitable = false;
-                this->_cond.notify_all();
-            }
+            size_t _batch_size;
 
-        private:
-            bool _is_waitable = false;
-            size_t _notify_size;
+            // producer only
+            std::vector<T> _pending;
+            Batch* _tail;
+
+            // consumer only; _head is the batch taken last, its `next` is
+            // the first one not yet taken
+            Batch* _head;
+            std::vector<T> _current;
+            size_t _pos = 0;
+
+            std::atomic<bool> _is_waitable{ false };
+            std::atomic<bool> _waiting{ false };
             std::mutex _lock;
             std::condition_variable _cond;
-            std::deque<T> data;
         };
 
         constexpr const int UNINITIALIZED_FIELD = -1;
     }
 
     /** Standard type for storing collection of rows */
-    using RowCollection = internals::ThreadSafeDeque<CSVRow>;
+    using RowCollection = internals::BatchQueue<CSVRow>;
 
     namespace internals {
         /** Abstract base class which provides CSV parsing logic.
@@ -6036,7 +6287,8 @@ namespace csv {
             IBasicCSVParser() = default;
             IBasicCSVParser(const CSVFormat&, const ColNamesPtr&);
             IBasicCSVParser(const ParseFlagMap& parse_flags, const WhitespaceMap& ws_flags
-            ) : _parse_flags(parse_flags), _ws_flags(ws_flags) {};
+            ) : _parse_flags(parse_flags), _ws_flags(ws_flags),
+                _unquoted_scanner(parse_flags, false), _quoted_scanner(parse_flags, true) {};
 
             virtual ~IBasicCSVParser() {}
 
@@ -6103,6 +6355,10 @@ namespace csv {
             bool quote_escape = false;
             bool field_has_double_quote = false;
 
+            /** Find the end of field contents, outside and inside quotes */
+            SpecialScanner _unquoted_scanner;
+            SpecialScanner _quoted_scanner;
+
             /** Where we are in the current data block */
             size_t data_pos = 0;
 
@@ -6138,7 +6394,7 @@ namespace csv {
          */
         template<typename TStream>
         class StreamParser: public IBasicCSVParser {
-            using RowCollection = ThreadSafeDeque<CSVRow>;
+            using RowCollection = BatchQueue<CSVRow>;
 
         public:
             StreamParser(TStream& source,
@@ -6227,6 +6483,37 @@ namespace csv {
             std::string _filename;
             size_t mmap_pos = 0;
         };
+
+        /** A block of CSV text owned by the caller */
+        struct MemorySource {
+            csv::string_view data;
+        };
+
+        /** Parser for CSV text that is already in memory, e.g. one slice of
+         *  a file that the caller has mapped itself
+         *
+         *  @par Implementation
+         *  Works like MmapParser but hands out views into the caller's
+         *  buffer instead of copying or mapping it again. The buffer must
+         *  outlive the parser and every CSVRow produced from it.
+         */
+        class MemoryParser : public IBasicCSVParser {
+        public:
+            MemoryParser(csv::string_view source,
+                const CSVFormat& format,
+                const ColNamesPtr& col_names = nullptr
+            ) : IBasicCSVParser(format, col_names), _source(source) {
+                this->source_size = source.size();
+            };
+
+            ~MemoryParser() {}
+
+            void next(size_t bytes) override;
+
+        private:
+            csv::string_view _source;
+            size_t source_pos = 0;
+        };
     }
 }
 
@@ -6408,7 +6695,7 @@ namespace csv {
         std::unique_ptr<internals::IBasicCSVParser> parser = nullptr;
 
         /** Queue of parsed CSV rows */
-        std::unique_ptr<RowCollection> records{new RowCollection(100)};
+        std::unique_ptr<RowCollection> records{new RowCollection(256)};
 
         size_t n_cols = 0;  /**< The number of columns in this CSV */
         size_t _n_rows = 0; /**< How many rows (minus header) have been read so far */
@@ -6421,6 +6708,11 @@ namespace csv {
         /**@}*/
 
     private:
+        friend CSVReader parse_view(csv::string_view data, CSVFormat format);
+
+        /** Parse text owned by the caller, see parse_view() */
+        CSVReader(internals::MemorySource source, CSVFormat format);
+
         /** Whether or not rows before header were trimmed */
         bool header_trimmed = false;
 
@@ -6520,6 +6812,7 @@ namespace csv {
     CSVReader operator ""_csv_no_header(const char*, size_t);
     CSVReader parse(csv::string_view in, CSVFormat format = CSVFormat());
     CSVReader parse_no_header(csv::string_view in);
+    CSVReader parse_view(csv::string_view data, CSVFormat format = CSVFormat());
     ///@}
 
     /** @name Utility Functions */
@@ -6987,6 +7280,9 @@ namespace csv {
             _ws_flags = internals::make_ws_flags(
                 format.trim_chars.data(), format.trim_chars.size()
             );
+
+            _unquoted_scanner = SpecialScanner(_parse_flags, false);
+            _quoted_scanner = SpecialScanner(_parse_flags, true);
         }
 
         CSV_INLINE void IBasicCSVParser::end_feed() {
@@ -7022,8 +7318,8 @@ namespace csv {
             // Optimization: Since NOT_SPECIAL characters tend to occur in contiguous
             // sequences, use the loop below to avoid having to go through the outer
             // switch statement as much as possible
-            while (data_pos < in.size() && compound_parse_flag(in[data_pos]) == ParseFlags::NOT_SPECIAL)
-                data_pos++;
+            const auto& scanner = quote_escape ? _quoted_scanner : _unquoted_scanner;
+            data_pos = scanner.find(in.data(), data_pos, in.size());
 
             field_length = data_pos - (field_start + current_row_start());
 
@@ -7200,6 +7496,29 @@ namespace csv {
 
             this->mmap_pos -= (length - remainder);
         }
+
+        CSV_INLINE void MemoryParser::next(size_t bytes = ITERATION_CHUNK_SIZE) {
+            // Reset parser state
+            this->field_start = UNINITIALIZED_FIELD;
+            this->field_length = 0;
+            this->reset_data_ptr();
+
+            // View the next window of the caller's buffer
+            size_t length = std::min(this->source_size - this->source_pos, bytes);
+            this->data_ptr->data = this->_source.substr(this->source_pos, length);
+            this->source_pos += length;
+
+            // Parse
+            this->current_row = CSVRow(this->data_ptr);
+            size_t remainder = this->parse();
+
+            if (this->source_pos == this->source_size || no_chunk()) {
+                this->_eof = true;
+                this->end_feed();
+            }
+
+            this->source_pos -= (length - remainder);
+        }
 #ifdef _MSC_VER
 #pragma endregion
 #endif
@@ -7361,6 +7680,7 @@ namespace csv {
             StreamParser<std::stringstream> parser(source, format);
             parser.set_output(rows);
             parser.next();
+            rows.flush();
 
             return CSVRow(std::move(rows[format.get_header()]));
         }
@@ -7379,6 +7699,7 @@ namespace csv {
             StreamParser<std::stringstream> parser(source, format);
             parser.set_output(rows);
             parser.next();
+            rows.flush();
 
             for (size_t i = 0; i < rows.size(); i++) {
                 auto& row = rows[i];
@@ -7497,6 +7818,21 @@ namespace csv {
         this->initial_read();
     }
 
+    /** Reads CSV text the caller already holds in memory, without copying it.
+     *
+     *  @note Delimiter guessing is not done here, so `format` should
+     *        spell the dialect out (and usually the column names).
+     */
+    CSV_INLINE CSVReader::CSVReader(internals::MemorySource source, CSVFormat format) : _format(format) {
+        using Parser = internals::MemoryParser;
+
+        if (!format.col_names.empty())
+            this->set_col_names(format.col_names);
+
+        this->parser = std::unique_ptr<Parser>(new Parser(source.data, format, this->col_names)); // For C++11
+        this->initial_read();
+    }
+
     /** Return the format of the original raw CSV */
     CSV_INLINE CSVFormat CSVReader::get_format() const {
         CSVFormat new_format = this->_format;
@@ -7571,6 +7907,7 @@ namespace csv {
 
         this->parser->set_output(*this->records);
         this->parser->next(bytes);
+        this->records->flush();
 
         if (!this->header_trimmed) {
             this->trim_header();
@@ -7602,6 +7939,9 @@ namespace csv {
                 if (this->records->is_waitable())
                     // Reading thread is currently active => wait for it to populate records
                     this->records->wait();
+                else if (!this->records->empty())
+                    // Reading thread published its last batch on the way out
+                    continue;
                 else if (this->parser->eof())
                     // End of file and no more records
                     return false;
@@ -7710,14 +8050,36 @@ namespace csv {
         CSV_INLINE RawCSVField& CSVFieldList::operator[](size_t n) const {
             const size_t page_no = n / _single_buffer_capacity;
             const size_t buffer_idx = (page_no < 1) ? n : n % _single_buffer_capacity;
-            return this->buffers[page_no][buffer_idx];
+            return this->buffer(page_no)[buffer_idx];
+        }
+
+        CSV_INLINE std::unique_ptr<RawCSVField[]>& CSVFieldList::buffer(size_t page_no) const {
+            size_t group = 0, first = 0, size = FIRST_GROUP;
+            while (page_no >= first + size) {
+                first += size;
+                size *= 2;
+                group++;
+            }
+            return this->groups[group][page_no - first];
         }
 
         CSV_INLINE void CSVFieldList::allocate() {
-            buffers.push_back(std::unique_ptr<RawCSVField[]>(new RawCSVField[_single_buffer_capacity]));
+            size_t group = 0, first = 0, size = FIRST_GROUP;
+            while (_buffer_count >= first + size) {
+                first += size;
+                size *= 2;
+                group++;
+            }
+            if (!groups[group]) {
+                groups[group].reset(new std::unique_ptr<RawCSVField[]>[size]);
+            }
+
+            auto& page = groups[group][_buffer_count - first];
+            page.reset(new RawCSVField[_single_buffer_capacity]);
+            _buffer_count++;
 
             _current_buffer_size = 0;
-            _back = buffers.back().get();
+            _back = page.get();
         }
     }
 
@@ -8519,6 +8881,14 @@ namespace csv {
         return CSVReader(stream, format);
     }
 
+    /** Parse an in-memory CSV string without copying it
+     *
+     *  @note `data` must outlive the returned reader and its rows
+     */
+    CSV_INLINE CSVReader parse_view(csv::string_view data, CSVFormat format) {
+        return CSVReader(internals::MemorySource{ data }, format);
+    }
+
     /** Parses a CSV string with no headers
      *
      *  @return A collection of CSVRow objects
@@ -0,0 +1,599 @@
+#include "csv_loader.hpp"
+#include "csv.hpp"
+#include "decompress.hpp"
+#include "numbers.hpp"
+#include "parallel.hpp"
+#include "read_behind.hpp"
+#include "row_index.hpp"
+#include "timestamp.hpp"
+#include "water_schema.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// Rough size of an EA export row, used to size the row columns up front
+static const size_t ESTIMATED_ROW_BYTES = 300;
+// slices smaller than this are not worth a thread of their own
+static const size_t MIN_SLICE_BYTES = 1 << 20;
+
+// End of the record that contains `pos`, given whether `pos` is inside a
+// quoted field. Returns data.size() if the record runs to the end.
+static size_t recordEnd(string_view data, size_t pos, bool quoted) {
+  for (; pos < data.size(); pos++) {
+    if (data[pos] == '"')
+      quoted = !quoted;
+    else if (data[pos] == '\n' && !quoted)
+      return pos + 1;
+  }
+  return data.size();
+}
+
+// Cuts data[begin, end) into `parts` slices that each start on a record,
+// the last one running on to the end of the record that contains `end`.
+// The quote count of each nominal slice is taken in parallel so the quote
+// state at every cut is known without scanning the range twice serially.
+// `mapped` if data is a file mapping, whose pages go once counted.
+static vector<size_t> splitRecords(string_view data, size_t begin, size_t end,
+                                   size_t parts, bool mapped) {
+  size_t size = end - begin;
+  vector<size_t> nominal(parts + 1);
+  for (size_t i = 0; i <= parts; i++)
+    nominal[i] = begin + size * i / parts;
+
+  vector<size_t> quotes(parts, 0);
+  runParallel(parts, [&](size_t i) {
+    ReadBehind behind(mapped ? data : string_view(), nominal[i],
+                      nominal[i + 1]);
+    for (size_t at = nominal[i]; at < nominal[i + 1];) {
+      size_t stop = min(nominal[i + 1], at + ReadBehind::WINDOW_BYTES);
+      quotes[i] += count(data.begin() + at, data.begin() + stop, '"');
+      behind.reached(stop);
+      at = stop;
+    }
+  });
+
+  size_t total = 0;
+  for (size_t q : quotes)
+    total += q;
+  size_t last = end < data.size() ? recordEnd(data, end, total % 2)
+                                  : data.size();
+
+  vector<size_t> cuts{begin};
+  size_t before = 0;
+  for (size_t i = 1; i < parts; i++) {
+    before += quotes[i - 1];
+    size_t cut = recordEnd(data, nominal[i], before % 2);
+    if (cut > cuts.back() && cut < last)
+      cuts.push_back(cut);
+  }
+  cuts.push_back(last);
+  return cuts;
+}
+
+// `mapped` is the buffer the reader parses, when the store may borrow text
+// from it rather than copy; empty to copy everything. `behind` is told of
+// every row read from a file mapping.
+static void ingestRows(csv::CSVReader &reader, const ColumnBinding &columns,
+                       ColumnStore &store, SliceProgress &progress,
+                       const LoadSpec &spec, string_view mapped = {},
+                       ReadBehind *behind = nullptr) {
+  auto &pool = store.strings;
+  TimestampParser timestamps;
+  RowFilter filter(spec);
+  auto kept = spec.keptColumns();
+  // the point and sample of the previous row kept
+  int p = -1, s = -1;
+  for (const auto &row : reader) {
+    auto raw = [&](Column column) {
+      if (!columns.has(column))
+        return csv::string_view();
+      return row[columns[column]].get<csv::string_view>();
+    };
+    if (behind)
+      behind->reached(raw(Column::SamplingPointNotation).data());
+    if (filter.active() &&
+        !(filter.keepPoint(raw(Column::SamplingPointNotation)) &&
+          filter.keepTime(raw(Column::SampleDateTime)) &&
+          filter.keepDeterminand(raw(Column::DeterminandNotation),
+                                 raw(Column::DeterminandLabel)))) {
+      progress.row();
+      continue;
+    }
+
+    // columns projected away read as empty
+    auto text = [&](Column column) {
+      return kept[(size_t)column] ? raw(column) : csv::string_view();
+    };
+    // unescaped fields live in the reader, not the mapping
+    auto intern = [&](Column column) {
+      auto value = text(column);
+      auto at = reinterpret_cast<uintptr_t>(value.data());
+      auto start = reinterpret_cast<uintptr_t>(mapped.data());
+      bool borrow = !mapped.empty() && at >= start &&
+                    at + value.size() <= start + mapped.size();
+      return pool.intern(value, borrow);
+    };
+    // plain numbers are parsed directly, anything else goes through
+    // CSVField's type detection (and its errors) as before
+    auto integer = [&](Column column) {
+      int value;
+      if (!kept[(size_t)column])
+        return 0;
+      if (parseInt(text(column), value))
+        return value;
+      return row[columns[column]].get<int>();
+    };
+    auto real = [&](Column column) {
+      double value;
+      if (parseDouble(text(column), value))
+        return value;
+      return row[columns[column]].get<double>();
+    };
+
+    // Exports are grouped by point and sorted by time, so a row is nearly
+    // always in the previous row's sample. Comparing the two keys' text is
+    // then all it takes; the rest is read only when a run breaks.
+    if (p < 0 || text(Column::SamplingPointNotation) !=
+                     pool.str(store.pointNotation[p])) {
+      auto samplingPoint = intern(Column::SamplingPointNotation);
+      auto northing = integer(Column::SamplingPointNorthing);
+      auto easting = integer(Column::SamplingPointEasting);
+      auto samplingPointLabel = intern(Column::SamplingPointLabel);
+      p = store.findPoint(samplingPoint);
+      if (p < 0) {
+        p = store.addPoint(samplingPoint, northing, easting,
+                           samplingPointLabel);
+      }
+      s = -1;
+    }
+
+    if (s < 0 ||
+        text(Column::SampleDateTime) != pool.str(store.sampleDateTime[s])) {
+      auto samplePurposeLabel = intern(Column::SamplePurpose);
+      auto materialType = intern(Column::SampledMaterialType);
+      auto datetime = intern(Column::SampleDateTime);
+      s = store.findSample(p, datetime);
+      if (s < 0) {
+        // parsed once per sample so the pages never touch the string again
+        auto time = timestamps.parse(pool.str(datetime));
+        bool isComp = text(Column::IsComplianceSample) == "true";
+        s = store.addSample(p, isComp, samplePurposeLabel, datetime,
+                            time.value_or(ColumnStore::NO_TIME), materialType);
+      }
+    }
+
+    auto determinandNotation = intern(Column::DeterminandNotation);
+    auto result = real(Column::Result);
+
+    int d = store.findDeterminand(determinandNotation);
+    if (d < 0) {
+      auto determinandLabel = intern(Column::DeterminandLabel);
+      auto determinandDef = intern(Column::DeterminandDefinition);
+      auto determinandUnitLabel = intern(Column::DeterminandUnitLabel);
+      d = store.addDeterminand(determinandLabel, determinandDef,
+                               determinandNotation, determinandUnitLabel);
+    }
+
+    store.addRow(s, d, result);
+    progress.row();
+  }
+  progress.done();
+}
+
+static mio::mmap_source mapFile(const string &filename) {
+  error_code error;
+  mio::mmap_source file = mio::make_mmap_source(filename, error);
+  if (error)
+    throw runtime_error("Unable to open " + filename + ": " + error.message());
+  return file;
+}
+
+// Tails, indexes and ranges are byte offsets into the csv text itself
+static void requireUncompressed(const string &filename) {
+  if (compressionOf(filename) != Compression::None)
+    throw runtime_error(filename +
+                        " is compressed and cannot be read by offset");
+}
+
+// The header is parsed on its own so every slice gets the column names.
+// Sets `headerEnd` to the offset of the first row.
+static ColumnBinding readHeader(string_view data, size_t &headerEnd,
+                                csv::CSVFormat &format, const LoadSpec &spec) {
+  headerEnd = recordEnd(data, 0, false);
+  auto header = csv::parse_view(data.substr(0, headerEnd));
+  auto names = header.get_col_names();
+  format.column_names(names);
+  return ColumnBinding(names, spec.readColumns());
+}
+
+// Parses data[begin, end) on one thread per core, `end` moving on to the
+// end of the record it falls in, and appends a store per slice to `parts`
+// in file order. `owner` holds `data` when that is the mapped file: with
+// mapText the stores borrow their text from it, and its pages are released
+// as they are read. Without an owner the text is copied. `countBytes` is
+// false when progress is kept in other bytes than these.
+static void ingestRecords(string_view data, size_t begin, size_t &end,
+                          const ColumnBinding &columns,
+                          const csv::CSVFormat &format,
+                          const CsvLoadOptions &options,
+                          const shared_ptr<const void> &owner,
+                          vector<ColumnStore> &parts,
+                          bool countBytes = true) {
+  auto progress = options.progress;
+  bool borrow = options.mapText && owner;
+  size_t threads = parallelism();
+  size_t slices =
+      min(threads, max<size_t>(1, (end - begin) / MIN_SLICE_BYTES));
+  auto cuts = splitRecords(data, begin, end, slices, owner != nullptr);
+  slices = cuts.size() - 1;
+
+  vector<ColumnStore> partial(slices);
+  runParallel(slices, [&](size_t i) {
+    auto reader = csv::parse_view(
+        data.substr(cuts[i], cuts[i + 1] - cuts[i]), format);
+    partial[i].reserveRows((cuts[i + 1] - cuts[i]) / ESTIMATED_ROW_BYTES);
+    if (borrow)
+      partial[i].strings.keepAlive(owner);
+    SliceProgress sliceProgress(progress,
+                                countBytes ? cuts[i + 1] - cuts[i] : 0,
+                                ESTIMATED_ROW_BYTES);
+    ReadBehind behind(owner ? data : string_view(), cuts[i], cuts[i + 1]);
+    ingestRows(reader, columns, partial[i], sliceProgress, options.spec,
+               borrow ? data : string_view(), &behind);
+  });
+  if (progress && progress->isCancelled())
+    throw LoadCancelled();
+
+  for (auto &slice : partial)
+    parts.push_back(std::move(slice));
+  end = cuts.back();
+}
+
+// The store built from every part so far, which are left as they are
+static ColumnStore preview(const vector<ColumnStore> &parts,
+                           DuplicatePolicy duplicates) {
+  auto copy = parts;
+  return ColumnStore::mergeAll(copy, duplicates, parallelism());
+}
+
+// End of the last complete record in data[begin, size), or `begin` if
+// there is none; `begin` must start a record.
+static size_t lastRecordEnd(string_view data, size_t begin) {
+  size_t quotes = count(data.begin() + begin, data.end(), '"');
+  size_t pos = data.size();
+  while (pos > begin) {
+    size_t newline = data.rfind('\n', pos - 1);
+    if (newline == string_view::npos || newline < begin)
+      break;
+    // a newline with an even number of quotes before it ends a record
+    quotes -= count(data.begin() + newline, data.begin() + pos, '"');
+    if (quotes % 2 == 0)
+      return newline + 1;
+    pos = newline;
+  }
+  return begin;
+}
+
+// decompressed text handed from the decompressing thread to the parser
+static const size_t DECOMPRESSED_CHUNK_BYTES = 8 << 20;
+// chunks decompressed ahead of the parser, which bounds the memory used
+static const size_t CHUNKS_IN_FLIGHT = 4;
+
+// A .csv.gz or .csv.zst file: one thread decompresses into a bounded queue
+// while this one cuts the text into whole records and parses them as
+// loadCsvFile parses a mapped file, so the load takes as long as the slower
+// of the two rather than both. Progress counts compressed bytes, the only
+// size known up front. The text is copied into the store since the
+// decompressed chunks are not kept.
+static void loadCompressedCsv(const string &filename, Compression compression,
+                              ColumnStore &store,
+                              const CsvLoadOptions &options) {
+  auto progress = options.progress;
+  const auto &onPartial = options.onPartial;
+  if (progress)
+    progress->totalBytes.fetch_add(fs::file_size(filename),
+                                   memory_order_relaxed);
+
+  BoundedQueue<string> chunks(CHUNKS_IN_FLIGHT);
+  exception_ptr failure;
+  thread decompressor([&] {
+    try {
+      decompressFile(filename, compression, DECOMPRESSED_CHUNK_BYTES, progress,
+                     [&](string &&chunk) {
+                       return chunks.push(std::move(chunk));
+                     });
+    } catch (...) {
+      failure = current_exception();
+    }
+    chunks.close();
+  });
+  // however parsing ends, the decompressor is stopped before returning
+  struct Stop {
+    BoundedQueue<string> &chunks;
+    thread &decompressor;
+    ~Stop() {
+      chunks.close();
+      decompressor.join();
+    }
+  } stop{chunks, decompressor};
+
+  csv::CSVFormat format;
+  optional<ColumnBinding> columns;
+  vector<ColumnStore> parts;
+  // text after the last complete record, carried into the next chunk
+  string pending;
+  size_t decompressed = 0;
+  size_t previewBytes = csv::internals::ITERATION_CHUNK_SIZE;
+  auto parse = [&](string_view data, size_t begin, size_t end) {
+    ingestRecords(data, begin, end, *columns, format, options, nullptr, parts,
+                  false);
+  };
+
+  string chunk;
+  while (chunks.pop(chunk)) {
+    decompressed += chunk.size();
+    pending.append(chunk);
+    size_t begin = 0;
+    if (!columns) {
+      begin = recordEnd(pending, 0, false);
+      // the header is not complete yet, or nothing has arrived
+      if (begin == pending.size() &&
+          (pending.empty() || pending.back() != '\n'))
+        continue;
+      columns.emplace(readHeader(pending, begin, format, options.spec));
+    }
+    size_t end = lastRecordEnd(pending, begin);
+    if (end > begin)
+      parse(string_view(pending).substr(0, end), begin, end);
+    pending.erase(0, end);
+
+    if (onPartial && decompressed >= previewBytes && !parts.empty()) {
+      onPartial(preview(parts, options.spec.duplicates));
+      previewBytes *= 2;
+    }
+  }
+  if (failure)
+    rethrow_exception(failure);
+  if (progress && progress->isCancelled())
+    throw LoadCancelled();
+
+  // a file without a trailing newline ends on a partial record
+  size_t begin = 0;
+  if (!columns)
+    columns.emplace(readHeader(pending, begin, format, options.spec));
+  if (begin < pending.size())
+    parse(pending, begin, pending.size());
+
+  store = ColumnStore::mergeAll(parts, options.spec.duplicates, parallelism());
+}
+
+void loadCsvFile(const string &filename, ColumnStore &store,
+                 const CsvLoadOptions &options) {
+  auto compression = compressionOf(filename);
+  if (compression != Compression::None) {
+    loadCompressedCsv(filename, compression, store, options);
+    return;
+  }
+
+  auto progress = options.progress;
+  const auto &onPartial = options.onPartial;
+  // shared with every pool that borrows text from it
+  auto file = make_shared<const mio::mmap_source>(mapFile(filename));
+  string_view data(file->data(), file->size());
+  if (progress)
+    progress->totalBytes.fetch_add(data.size(), memory_order_relaxed);
+
+  size_t headerEnd;
+  csv::CSVFormat format;
+  auto columns = readHeader(data, headerEnd, format, options.spec);
+
+  vector<ColumnStore> parts;
+  size_t begin = headerEnd;
+  // rounds double in size so publishing a copy after each one costs no more
+  // than one extra copy of the whole store
+  size_t roundBytes = csv::internals::ITERATION_CHUNK_SIZE;
+  while (begin < data.size()) {
+    // without a listener the whole file is a single round
+    size_t end = onPartial ? min(data.size(), begin + roundBytes) : data.size();
+    ingestRecords(data, begin, end, columns, format, options, file, parts);
+
+    begin = end;
+    if (onPartial && begin < data.size()) {
+      onPartial(preview(parts, options.spec.duplicates));
+      roundBytes *= 2;
+    }
+  }
+  // the header counts as read once every row is
+  if (progress)
+    progress->bytes.fetch_add(headerEnd, memory_order_relaxed);
+
+  store = ColumnStore::mergeAll(parts, options.spec.duplicates, parallelism());
+}
+
+size_t loadCsvTail(const string &filename, size_t offset, ColumnStore &store,
+                   const LoadSpec &spec) {
+  requireUncompressed(filename);
+  auto file = mapFile(filename);
+  string_view data(file.data(), file.size());
+
+  // nothing to read until the header line is complete
+  size_t headerEnd = recordEnd(data, 0, false);
+  if (headerEnd == data.size() && (data.empty() || data.back() != '\n'))
+    return offset;
+  csv::CSVFormat format;
+  auto columns = readHeader(data, headerEnd, format, spec);
+
+  // only complete records, a row still being written is left for next time
+  size_t begin = max(offset, headerEnd);
+  size_t end = begin;
+  bool quoted = false;
+  for (size_t pos = begin; pos < data.size(); pos++) {
+    if (data[pos] == '"')
+      quoted = !quoted;
+    else if (data[pos] == '\n' && !quoted)
+      end = pos + 1;
+  }
+  if (end == begin)
+    return begin;
+
+  auto reader = csv::parse_view(data.substr(begin, end - begin), format);
+  SliceProgress progress(nullptr, end - begin, ESTIMATED_ROW_BYTES);
+  ingestRows(reader, columns, store, progress, spec);
+  store.finalize(spec.duplicates);
+  return end;
+}
+
+// Splits a field out of a record the way the parser would for a plain
+// quoted or unquoted value; escaped quotes are left doubled.
+static string_view unquote(string_view field) {
+  if (!field.empty() && field.back() == '\r')
+    field.remove_suffix(1);
+  if (field.size() >= 2 && field.front() == '"' && field.back() == '"')
+    field = field.substr(1, field.size() - 2);
+  return field;
+}
+
+// Adds every record in data[begin, end) to `index`. Only two fields are
+// needed, so the record is split here rather than run through the parser:
+// byte by byte up to the later of the two, then from newline to newline,
+// keeping track of quotes, to the end of the record. `data` is the mapped
+// file, whose pages go as they are read.
+static void indexRecords(string_view data, size_t begin, size_t end,
+                         const ColumnBinding &columns, RowIndex &index) {
+  ReadBehind behind(data, begin, end);
+  size_t pointField = columns[Column::SamplingPointNotation];
+  size_t timeField = columns[Column::SampleDateTime];
+  size_t lastField = max(pointField, timeField);
+  size_t pos = begin;
+  while (pos < end) {
+    size_t start = pos, field = 0, fieldStart = pos;
+    string_view point, time;
+    bool quoted = false, ended = false;
+    for (; field <= lastField; pos++) {
+      ended = pos == end || (data[pos] == '\n' && !quoted);
+      if (!ended && data[pos] == '"')
+        quoted = !quoted;
+      else if (ended || (data[pos] == ',' && !quoted)) {
+        auto value = data.substr(fieldStart, pos - fieldStart);
+        if (field == pointField)
+          point = unquote(value);
+        else if (field == timeField)
+          time = unquote(value);
+        field++;
+        fieldStart = pos + 1;
+      }
+      if (ended)
+        break;
+    }
+    while (!ended) {
+      auto newline = (const char *)memchr(data.data() + pos, '\n', end - pos);
+      size_t stop = newline ? newline - data.data() : end;
+      quoted ^= count(data.begin() + pos, data.begin() + stop, '"') % 2;
+      pos = stop;
+      ended = pos == end || !quoted;
+      if (!ended)
+        pos++;
+    }
+    pos = min(pos + 1, end);
+    index.add(point, RowIndex::monthOf(time), start, pos);
+    behind.reached(pos);
+  }
+}
+
+RowIndex buildRowIndex(const string &filename) {
+  requireUncompressed(filename);
+  auto file = mapFile(filename);
+  string_view data(file.data(), file.size());
+
+  size_t headerEnd;
+  csv::CSVFormat format;
+  LoadSpec keys;
+  keys.columns.reset();
+  auto columns = readHeader(data, headerEnd, format, keys);
+
+  size_t threads = parallelism();
+  size_t parts = min(threads, max<size_t>(1, (data.size() - headerEnd) /
+                                                 MIN_SLICE_BYTES));
+  auto cuts = splitRecords(data, headerEnd, data.size(), parts, true);
+  parts = cuts.size() - 1;
+
+  vector<RowIndex> partial(parts);
+  runParallel(parts, [&](size_t i) {
+    indexRecords(data, cuts[i], cuts[i + 1], columns, partial[i]);
+  });
+  for (size_t i = 1; i < parts; i++) {
+    partial[0].merge(partial[i]);
+    partial[i] = RowIndex();
+  }
+  partial[0].finalize();
+  return std::move(partial[0]);
+}
+
+void loadCsvRanges(const string &filename, const vector<ByteRange> &ranges,
+                   ColumnStore &store, const CsvLoadOptions &options) {
+  auto progress = options.progress;
+  requireUncompressed(filename);
+  auto file = mapFile(filename);
+  string_view data(file.data(), file.size());
+
+  size_t headerEnd;
+  csv::CSVFormat format;
+  auto columns = readHeader(data, headerEnd, format, options.spec);
+
+  // a range that does not start on a record means the index is stale
+  size_t total = 0;
+  for (auto range : ranges) {
+    if (range.begin == 0 || range.begin < headerEnd || range.begin > range.end ||
+        range.end > data.size() || data[range.begin - 1] != '\n')
+      throw runtime_error("The row index does not match " + filename);
+    total += range.end - range.begin;
+  }
+  if (progress)
+    progress->totalBytes.fetch_add(total, memory_order_relaxed);
+
+  // every thread takes a run of consecutive ranges of about the same size
+  size_t threads = parallelism();
+  size_t parts = min({threads, max<size_t>(1, ranges.size()),
+                      max<size_t>(1, total / MIN_SLICE_BYTES)});
+  vector<size_t> firstRange{0};
+  size_t bytes = 0;
+  for (size_t r = 0; r < ranges.size(); r++) {
+    bytes += ranges[r].end - ranges[r].begin;
+    if (bytes * parts >= total * firstRange.size() &&
+        firstRange.size() < parts)
+      firstRange.push_back(r + 1);
+  }
+  firstRange.resize(parts, ranges.size());
+  firstRange.push_back(ranges.size());
+
+  // Each thread copies its ranges out back to back and parses them with one
+  // reader; starting a reader per range costs more than the copy once there
+  // are thousands of small ranges. With mapText the text is borrowed from
+  // that copy instead of the mapping.
+  vector<ColumnStore> partial(parts);
+  runParallel(parts, [&](size_t i) {
+    auto rows = make_shared<string>();
+    for (size_t r = firstRange[i]; r < firstRange[i + 1]; r++)
+      rows->append(data.substr(ranges[r].begin, ranges[r].end - ranges[r].begin));
+    if (options.mapText)
+      partial[i].strings.keepAlive(rows);
+
+    auto reader = csv::parse_view(*rows, format);
+    SliceProgress sliceProgress(progress, rows->size(), ESTIMATED_ROW_BYTES);
+    ingestRows(reader, columns, partial[i], sliceProgress, options.spec,
+               options.mapText ? string_view(*rows) : string_view());
+  });
+  if (progress && progress->isCancelled())
+    throw LoadCancelled();
+
+  store = ColumnStore::mergeAll(partial, options.spec.duplicates, threads);
+}
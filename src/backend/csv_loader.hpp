@@ -0,0 +1,80 @@
+// Parallel csv ingest into a ColumnStore
+
+#pragma once
+
+#include "column_store.hpp"
+#include "load_progress.hpp"
+#include "load_spec.hpp"
+#include "row_index.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * The file is memory mapped and cut into one slice per core, each slice
+ * starting at the beginning of a record (newlines inside quoted fields are
+ * skipped by tracking quote parity). Every slice is parsed into its own
+ * ColumnStore on its own thread, then ColumnStore::mergeAll() builds the
+ * partial stores into one, in file order and again on every core, so the
+ * result is the same as a single-threaded load.
+ *
+ * Columns are bound by name once against the header (see water_schema.hpp).
+ * Throws std::runtime_error if the file cannot be mapped or any required
+ * column is missing, before any row is read.
+ *
+ * If `progress` is given, bytes and rows are added to it as slices advance,
+ * and LoadCancelled is thrown soon after it is cancelled; `store` is left
+ * untouched in that case.
+ *
+ * If `onPartial` is given, the file is read in rounds starting at
+ * csv::internals::ITERATION_CHUNK_SIZE bytes and doubling, and after every
+ * round but the last it is handed a finalized copy of everything read so
+ * far. It is called on the loading thread.
+ *
+ * With `mapText` the store's text points straight into the mapping, which
+ * its string pool (and every copy or merge of it) keeps open, so ingest
+ * copies no text at all. Fields the parser had to unescape ("") are still
+ * copied. The file must not be truncated or rewritten in place while the
+ * store is alive; appending to it is fine. Either way the mapping's pages
+ * are given back as the loader reads past them (see read_behind.hpp), so
+ * of the file only the pages holding text that is read again stay resident.
+ *
+ * Only the rows and columns `spec` keeps are loaded, see load_spec.hpp.
+ * Columns it leaves out may be missing from the file.
+ *
+ * A gzip or zstd compressed csv (see decompress.hpp) is decompressed on a
+ * thread of its own, a few chunks ahead of the parser, instead of being
+ * mapped; progress then counts compressed bytes and `mapText` is ignored.
+ * loadCsvTail, buildRowIndex and loadCsvRanges need the plain text and throw
+ * std::runtime_error for such a file.
+ */
+using PartialStore = std::function<void(ColumnStore &&)>;
+
+struct CsvLoadOptions {
+  LoadProgress *progress = nullptr;
+  PartialStore onPartial;
+  bool mapText = false;
+  LoadSpec spec;
+};
+
+void loadCsvFile(const std::string &filename, ColumnStore &store,
+                 const CsvLoadOptions &options = {});
+
+// Reads the complete records a growing csv has gained past `offset` (as
+// returned by the previous call, or the file's size when it was loaded) into
+// `store`, finalized. Returns the offset to continue from next time; a
+// trailing partial row is left for then. Only rows `spec` keeps are read.
+size_t loadCsvTail(const std::string &filename, size_t offset,
+                   ColumnStore &store, const LoadSpec &spec = {});
+
+// Scans the csv for where each sampling point's rows are, see row_index.hpp.
+// Throws std::runtime_error like loadCsvFile.
+RowIndex buildRowIndex(const std::string &filename);
+
+// Loads the rows in `ranges` (from a RowIndex built for the file as it is
+// now, in file order) like loadCsvFile loads the whole file. Ranges may take
+// in rows the caller does not want, `options.spec` should filter them out.
+// Throws std::runtime_error if a range does not start on a record.
+void loadCsvRanges(const std::string &filename,
+                   const std::vector<ByteRange> &ranges, ColumnStore &store,
+                   const CsvLoadOptions &options = {});
@@ -1,86 +1,153 @@
 // COMP2811 Coursework 1 sample solution: QuakeDataset class
 
 #include "dataset.hpp"
-#include "csv.hpp"
+#include "csv_loader.hpp"
+#include "decompress.hpp"
+#include "json_loader.hpp"
+#include "parallel.hpp"
+#include "row_index.hpp"
+#include "snapshot.hpp"
 #include "water_sample.hpp"
 #include <QWidget>
 #include <string>
-#include <unordered_map>
 
 using namespace std;
 
-WaterDataset::WaterDataset() {
-  data = new std::unordered_map<string, SamplingPoint *>;
+WaterDataset::WaterDataset() {}
+WaterDataset::WaterDataset(const QString &filename) { loadData(filename); }
+
+optional<SamplingPoint>
+WaterDataset::getFromNotation(string_view notation) const {
+  int p = store.findPoint(notation);
+  if (p < 0)
+    return nullopt;
+  return SamplingPoint(&store, p);
 }
-WaterDataset::WaterDataset(const QString &filename) {
-  data = new std::unordered_map<string, SamplingPoint *>;
-  loadData(filename);
+
+vector<SamplingPoint> WaterDataset::getFromLabel(string_view label) const {
+  vector<SamplingPoint> points;
+  int text = store.strings.find(label);
+  if (text < 0)
+    return points;
+
+  for (uint32_t p : store.findPointsByLabel(text)) {
+    points.push_back(SamplingPoint(&store, p));
+  }
+  return points;
 }
 
-SamplingPoint *WaterDataset::getFromNotation(string &notation) {
-  auto p = (*data).find(notation);
-  if (p == data->end())
-    return nullptr;
+PartialStore WaterDataset::wrapPartial(const PartialDataset &onPartial) {
+  if (!onPartial)
+    return {};
+  return [&onPartial](ColumnStore &&preview) {
+    auto dataset = new WaterDataset();
+    dataset->store = std::move(preview);
+    onPartial(dataset);
+  };
+}
+
+// A csv or a JSON export, told apart by how the file starts
+static void loadSource(const string &filename, ColumnStore &store,
+                       const CsvLoadOptions &options) {
+  if (isJsonFile(filename))
+    loadJsonFile(filename, store, options);
   else
-    return p->second;
+    loadCsvFile(filename, store, options);
+}
+
+// Whether rows can be found by byte offset, which the row index needs
+static bool indexable(const string &filename) {
+  return !isJsonFile(filename) && compressionOf(filename) == Compression::None;
+}
+
+void WaterDataset::loadData(const QString &filename, LoadProgress *progress,
+                            const PartialDataset &onPartial) {
+  loadSource(filename.toStdString(), store,
+             {progress, wrapPartial(onPartial), mapText, loadSpec});
+}
+
+void WaterDataset::loadData(const QString &filename, const LoadSpec &spec,
+                            LoadProgress *progress,
+                            const PartialDataset &onPartial) {
+  setLoadSpec(spec);
+  loadData(filename, progress, onPartial);
+}
+
+// One file of a multi-file load, from its snapshot if that is still fresh
+static void loadFile(const string &filename, ColumnStore &store,
+                     const CsvLoadOptions &options) {
+  bool complete = options.spec.keepsEverything();
+  if (complete && loadSnapshot(filename, store))
+    return;
+  loadSource(filename, store, options);
+  if (complete)
+    saveSnapshot(store, filename);
 }
 
-SamplingPoint *WaterDataset::getFromLabel(string &label) {
-  for (auto p : *data) {
-    if (p.second->getLabel() == label) {
-      return p.second;
-    }
+void WaterDataset::loadFiles(const QStringList &filenames,
+                             LoadProgress *progress,
+                             const PartialDataset &onPartial) {
+  if (filenames.isEmpty())
+    return;
+  if (filenames.size() == 1) {
+    loadFile(filenames[0].toStdString(), store,
+             {progress, wrapPartial(onPartial), mapText, loadSpec});
+    return;
   }
-  return nullptr;
+
+  vector<ColumnStore> stores(filenames.size());
+  runParallel(stores.size(), [&](size_t i) {
+    loadFile(filenames[i].toStdString(), stores[i],
+             {progress, {}, mapText, loadSpec});
+  });
+
+  // in the order the files were given, so KeepFirst keeps the earlier file's
+  // row of a sample repeated across files
+  store = ColumnStore::mergeAll(stores, loadSpec.duplicates, parallelism());
 }
 
-void WaterDataset::loadData(const QString &filename) {
-  csv::CSVReader reader(filename.toStdString());
-
-  data->clear();
-  int sum = 0;
-  int sum_points = 0;
-  int samples = 0;
-  for (const auto &row : reader) {
-    auto samplingPoint = row["sample.samplingPoint.notation"].get<>();
-    auto northing = row["sample.samplingPoint.northing"].get<int>();
-    auto easting = row["sample.samplingPoint.easting"].get<int>();
-    auto samplingPointLabel = row["sample.samplingPoint.label"].get<>();
-
-    auto samplePurposeLabel = row["sample.purpose.label"].get<>();
-    auto materialType = row["sample.sampledMaterialType.label"].get<>();
-    auto datetime = row["sample.sampleDateTime"].get<>();
-
-    auto determinandLabel = row["determinand.label"].get<>();
-    auto determinandDef = row["determinand.definition"].get<>();
-    auto determinandNotation = row["determinand.notation"].get<>();
-    auto determinandUnitLabel = row["determinand.unit.label"].get<>();
-    auto result = row["result"].get<double>();
-
-    bool isComp;
-    if (row["sample.isComplianceSample"].get<>() == "true") {
-      isComp = true;
-    } else {
-      isComp = false;
-    }
-
-    auto p = getFromNotation(samplingPoint);
-    if (p == nullptr) {
-      p = new SamplingPoint(samplingPoint, northing, easting,
-                            samplingPointLabel);
-      (*data)[samplingPoint] = p;
-    }
-
-    Sample *s = p->getSampleFromDateTime(datetime);
-    if (!s) {
-      s = new Sample(isComp, samplePurposeLabel, datetime, materialType);
-      p->addSample(s);
-    }
-
-    Determinand *d =
-        new Determinand(determinandLabel, determinandDef, determinandNotation,
-                        determinandUnitLabel, result);
-    s->addDeterminand(d);
-    sum++;
+void WaterDataset::loadPoint(const QString &filename, string_view notation,
+                             LoadProgress *progress) {
+  string source = filename.toStdString();
+  LoadSpec spec = loadSpec;
+  spec.points = {string(notation)};
+  // without an index the whole file is read, keeping only the point
+  if (!indexable(source)) {
+    loadSource(source, store, {progress, {}, mapText, spec});
+    return;
+  }
+
+  RowIndex index;
+  if (!loadRowIndex(source, index)) {
+    index = buildRowIndex(source);
+    saveRowIndex(index, source);
   }
+
+  // a month either side, the index's months are UTC and sample times local
+  optional<int32_t> first, last;
+  if (spec.from)
+    first = RowIndex::monthOf(*spec.from) - 1;
+  if (spec.to)
+    last = RowIndex::monthOf(*spec.to) + 1;
+  loadCsvRanges(source, index.find(notation, first, last), store,
+                {progress, {}, mapText, spec});
+}
+
+vector<SamplingPoint> WaterDataset::append(const ColumnStore &rows) {
+  store.append(rows, loadSpec.duplicates);
+
+  vector<SamplingPoint> points;
+  for (uint32_t p = 0; p < rows.pointCount(); p++) {
+    int id = store.findPoint(rows.strings.str(rows.pointNotation[p]));
+    points.push_back(SamplingPoint(&store, id));
+  }
+  return points;
+}
+
+bool WaterDataset::loadSnapshot(const QString &filename) {
+  return ::loadSnapshot(filename.toStdString(), store);
+}
+
+bool WaterDataset::saveSnapshot(const QString &filename) const {
+  return ::saveSnapshot(store, filename.toStdString());
 }
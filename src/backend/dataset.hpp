@@ -2,27 +2,79 @@
 
 #pragma once
 
+#include "column_store.hpp"
+#include "csv_loader.hpp"
+#include "load_progress.hpp"
 #include "water_sample.hpp"
 #include <QtWidgets>
-#include <unordered_map>
+#include <functional>
+#include <optional>
+#include <vector>
+
+class WaterDataset;
+
+// receives a partial dataset while a load is still running, and owns it
+using PartialDataset = std::function<void(WaterDataset *)>;
 
 class WaterDataset {
 public:
   WaterDataset();
   WaterDataset(const QString &filename);
-  void loadData(const QString &);
-  int size() const { return data->size(); }
-  bool hasElements() { return size() > 0; }
-  const std::unordered_map<std::string, SamplingPoint *> *getData() {
-    return data;
-  }
+  // may run on a worker thread, see csv_loader.hpp for `progress` and
+  // `onPartial`; .csv.gz and .csv.zst files are decompressed as they load,
+  // and EA JSON or JSON-LD exports are read by json_loader.hpp
+  void loadData(const QString &, LoadProgress *progress = nullptr,
+                const PartialDataset &onPartial = {});
+  // loads only what `spec` keeps (see load_spec.hpp); later loads and
+  // appended rows keep using it
+  void loadData(const QString &, const LoadSpec &spec,
+                LoadProgress *progress = nullptr,
+                const PartialDataset &onPartial = {});
+  // Loads every file concurrently (each from its snapshot when fresh) and
+  // merges them, matching points by notation and samples by (point,
+  // datetime). Partial datasets are only published for a single file.
+  void loadFiles(const QStringList &filenames,
+                 LoadProgress *progress = nullptr,
+                 const PartialDataset &onPartial = {});
+  // keep the text of the csvs loaded from now on in their mappings instead
+  // of copying it (see csv_loader.hpp); the files must not be rewritten in
+  // place while the dataset is alive
+  void setMapText(bool on) { mapText = on; }
+  // narrows the loads from now on; snapshots only hold complete files
+  // loaded with the default duplicate policy, so they are neither read nor
+  // written while the spec differs from the default
+  void setLoadSpec(const LoadSpec &spec) { loadSpec = spec; }
+  const LoadSpec &getLoadSpec() const { return loadSpec; }
+  // Loads only the rows of the sampling point `notation` (within the load
+  // spec's time range, if it has one) through the csv's .idx row index,
+  // building the index first if it is missing or stale. See row_index.hpp.
+  // A compressed csv or a JSON export has no index and is read through
+  // instead.
+  void loadPoint(const QString &filename, std::string_view notation,
+                 LoadProgress *progress = nullptr);
+  // Merges rows read after the load (see loadCsvTail) into the dataset and
+  // returns the sampling points they landed in.
+  std::vector<SamplingPoint> append(const ColumnStore &rows);
+  // binary snapshot next to the csv, see snapshot.hpp
+  bool loadSnapshot(const QString &filename);
+  bool saveSnapshot(const QString &filename) const;
+  int size() const { return store.pointCount(); }
+  bool hasElements() const { return size() > 0; }
 
-  SamplingPoint *getFromNotation(string &notation);
-  const std::unordered_map<std::string, SamplingPoint *> *getData() const {
-    return data;
+  SamplingPointRange getPoints() const {
+    return SamplingPointRange(&store, 0, store.pointCount());
   }
-  SamplingPoint *getFromLabel(std::string &label);
+  // flat row columns, for scans over every measurement
+  const ColumnStore &getColumns() const { return store; }
+
+  std::optional<SamplingPoint> getFromNotation(std::string_view notation) const;
+  // labels are not unique, so every point with the label is returned
+  std::vector<SamplingPoint> getFromLabel(std::string_view label) const;
 
 private:
-  std::unordered_map<std::string, SamplingPoint *> *data;
+  static PartialStore wrapPartial(const PartialDataset &onPartial);
+
+  ColumnStore store;
+  bool mapText = false;
+  LoadSpec loadSpec;
 };
@@ -0,0 +1,217 @@
+#include "decompress.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef WQ_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef WQ_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace std;
+
+// compressed bytes read from disk at a time
+static const size_t INPUT_BLOCK_BYTES = 1 << 20;
+
+static const unsigned char GZIP_MAGIC[2] = {0x1f, 0x8b};
+static const unsigned char ZSTD_MAGIC[4] = {0x28, 0xb5, 0x2f, 0xfd};
+
+Compression compressionOf(const string &filename) {
+  ifstream file(filename, ios::binary);
+  if (!file)
+    throw runtime_error("Unable to open " + filename);
+  unsigned char head[4] = {};
+  file.read((char *)head, sizeof(head));
+  size_t got = file.gcount();
+  if (got >= sizeof(GZIP_MAGIC) && memcmp(head, GZIP_MAGIC, 2) == 0)
+    return Compression::Gzip;
+  if (got >= sizeof(ZSTD_MAGIC) && memcmp(head, ZSTD_MAGIC, 4) == 0)
+    return Compression::Zstd;
+  return Compression::None;
+}
+
+// The compressed file, read a block at a time
+class InputBlocks {
+public:
+  InputBlocks(const string &filename, LoadProgress *progress)
+      : file(filename, ios::binary), progress(progress),
+        block(INPUT_BLOCK_BYTES) {
+    if (!file)
+      throw runtime_error("Unable to open " + filename);
+  }
+
+  // the next block, empty at the end of the file
+  string_view next() {
+    if (progress && progress->isCancelled())
+      throw LoadCancelled();
+    file.read(block.data(), block.size());
+    size_t got = file.gcount();
+    if (got == 0 && file.bad())
+      throw runtime_error("Unable to read compressed file");
+    if (progress)
+      progress->bytes.fetch_add(got, memory_order_relaxed);
+    return string_view(block.data(), got);
+  }
+
+private:
+  ifstream file;
+  LoadProgress *progress;
+  vector<char> block;
+};
+
+// Decompressed text being gathered into the next chunk
+class ChunkWriter {
+public:
+  ChunkWriter(size_t chunkBytes, const ChunkSink &sink)
+      : chunkBytes(chunkBytes), sink(sink) {
+    chunk.resize(chunkBytes);
+  }
+
+  char *space() { return chunk.data() + used; }
+  size_t room() const { return chunk.size() - used; }
+
+  // records `bytes` written at space(); returns false once the sink stops
+  bool produced(size_t bytes) {
+    used += bytes;
+    return used < chunk.size() || flush();
+  }
+
+  bool flush() {
+    if (used == 0)
+      return true;
+    chunk.resize(used);
+    bool more = sink(std::move(chunk));
+    chunk = string();
+    chunk.resize(chunkBytes);
+    used = 0;
+    return more;
+  }
+
+private:
+  size_t chunkBytes;
+  const ChunkSink &sink;
+  string chunk;
+  size_t used = 0;
+};
+
+#ifdef WQ_HAVE_ZLIB
+static void inflateGzip(InputBlocks &input, ChunkWriter &out) {
+  z_stream stream{};
+  // 15 + 32: any window size, with a gzip or zlib header
+  if (inflateInit2(&stream, 15 + 32) != Z_OK)
+    throw runtime_error("Unable to start gzip decompression");
+  struct End {
+    z_stream &stream;
+    ~End() { inflateEnd(&stream); }
+  } end{stream};
+
+  string_view block = input.next();
+  stream.next_in = (Bytef *)block.data();
+  stream.avail_in = block.size();
+  while (true) {
+    if (stream.avail_in == 0 && !block.empty()) {
+      block = input.next();
+      stream.next_in = (Bytef *)block.data();
+      stream.avail_in = block.size();
+    }
+    // zlib counts in uInt, so at most one chunk's room at a time
+    stream.next_out = (Bytef *)out.space();
+    stream.avail_out = out.room();
+    int status = inflate(&stream, Z_NO_FLUSH);
+    if (!out.produced(out.room() - stream.avail_out))
+      return;
+
+    if (status == Z_STREAM_END) {
+      // gzip files may be several members back to back
+      if (stream.avail_in == 0) {
+        block = input.next();
+        stream.next_in = (Bytef *)block.data();
+        stream.avail_in = block.size();
+        if (block.empty())
+          break;
+      }
+      inflateReset(&stream);
+    } else if (status == Z_BUF_ERROR && stream.avail_in == 0 &&
+               block.empty()) {
+      throw runtime_error("Truncated gzip file");
+    } else if (status != Z_OK && status != Z_BUF_ERROR) {
+      throw runtime_error(string("Damaged gzip file: ") +
+                          (stream.msg ? stream.msg : "inflate failed"));
+    }
+  }
+  out.flush();
+}
+#endif
+
+#ifdef WQ_HAVE_ZSTD
+static void decompressZstd(InputBlocks &input, ChunkWriter &out) {
+  ZSTD_DStream *stream = ZSTD_createDStream();
+  if (!stream)
+    throw runtime_error("Unable to start zstd decompression");
+  struct End {
+    ZSTD_DStream *stream;
+    ~End() { ZSTD_freeDStream(stream); }
+  } end{stream};
+  ZSTD_initDStream(stream);
+
+  // 0 once a frame is complete; frames may follow each other
+  size_t remaining = 0;
+  for (string_view block = input.next(); !block.empty();
+       block = input.next()) {
+    ZSTD_inBuffer in{block.data(), block.size(), 0};
+    while (in.pos < in.size) {
+      ZSTD_outBuffer buffer{out.space(), out.room(), 0};
+      remaining = ZSTD_decompressStream(stream, &buffer, &in);
+      if (ZSTD_isError(remaining))
+        throw runtime_error(string("Damaged zstd file: ") +
+                            ZSTD_getErrorName(remaining));
+      if (!out.produced(buffer.pos))
+        return;
+    }
+  }
+  // the last block may leave output buffered in the stream
+  while (remaining != 0) {
+    ZSTD_inBuffer in{nullptr, 0, 0};
+    ZSTD_outBuffer buffer{out.space(), out.room(), 0};
+    remaining = ZSTD_decompressStream(stream, &buffer, &in);
+    if (ZSTD_isError(remaining))
+      throw runtime_error(string("Damaged zstd file: ") +
+                          ZSTD_getErrorName(remaining));
+    if (buffer.pos == 0 && remaining != 0)
+      throw runtime_error("Truncated zstd file");
+    if (!out.produced(buffer.pos))
+      return;
+  }
+  out.flush();
+}
+#endif
+
+void decompressFile(const string &filename, Compression compression,
+                    size_t chunkBytes, LoadProgress *progress,
+                    const ChunkSink &sink) {
+  InputBlocks input(filename, progress);
+  ChunkWriter out(chunkBytes, sink);
+  switch (compression) {
+  case Compression::Gzip:
+#ifdef WQ_HAVE_ZLIB
+    inflateGzip(input, out);
+    return;
+#else
+    throw runtime_error("This build cannot read gzip files: " + filename);
+#endif
+  case Compression::Zstd:
+#ifdef WQ_HAVE_ZSTD
+    decompressZstd(input, out);
+    return;
+#else
+    throw runtime_error("This build cannot read zstd files: " + filename);
+#endif
+  case Compression::None:
+    break;
+  }
+  throw runtime_error(filename + " is not compressed");
+}
@@ -0,0 +1,31 @@
+// Streaming decompression of .csv.gz and .csv.zst files
+
+#pragma once
+
+#include "load_progress.hpp"
+#include <functional>
+#include <string>
+#include <string_view>
+
+/*
+ * The format is told from the file's first bytes rather than its name, so
+ * a renamed file still loads. gzip is read through zlib (concatenated
+ * members included) and zstd through libzstd (concatenated frames
+ * included); each is only there if the build found the library
+ * (WQ_HAVE_ZLIB, WQ_HAVE_ZSTD).
+ */
+enum class Compression { None, Gzip, Zstd };
+
+// Throws std::runtime_error if the file cannot be opened.
+Compression compressionOf(const std::string &filename);
+
+// Receives the next piece of decompressed text; returns false to stop early.
+using ChunkSink = std::function<bool(std::string &&)>;
+
+// Decompresses `filename` into pieces of `chunkBytes` (the last one may be
+// shorter), handing each to `sink` as soon as it is full. Compressed bytes
+// are added to `progress` as they are consumed. Throws std::runtime_error
+// if the file is damaged or truncated, or the build cannot read its format.
+void decompressFile(const std::string &filename, Compression compression,
+                    size_t chunkBytes, LoadProgress *progress,
+                    const ChunkSink &sink);
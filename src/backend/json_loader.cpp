@@ -0,0 +1,791 @@
+#include "json_loader.hpp"
+#include "csv.hpp"
+#include "load_spec.hpp"
+#include "numbers.hpp"
+#include "parallel.hpp"
+#include "read_behind.hpp"
+#include "timestamp.hpp"
+#include "water_schema.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Rough size of one measurement in an API export, @ids and all
+static const size_t ESTIMATED_ITEM_BYTES = 1200;
+// slices smaller than this are not worth a thread of their own
+static const size_t MIN_SLICE_BYTES = 1 << 20;
+
+// The column paths as a tree of object keys; node 0 is the measurement
+class FieldTree {
+public:
+  static constexpr int NONE = -1;
+
+  FieldTree() {
+    nodes.emplace_back();
+    for (size_t c = 0; c < COLUMN_COUNT; c++) {
+      int node = 0;
+      string_view path = COLUMN_NAMES[c];
+      while (true) {
+        size_t dot = path.find('.');
+        auto key = path.substr(0, dot);
+        int next = child(node, key);
+        if (next == NONE) {
+          next = nodes.size();
+          nodes[node].children.push_back({key, next});
+          nodes.emplace_back();
+        }
+        node = next;
+        if (dot == string_view::npos)
+          break;
+        path.remove_prefix(dot + 1);
+      }
+      nodes[node].column = c;
+    }
+  }
+
+  int child(int node, string_view key) const {
+    if (node == NONE)
+      return NONE;
+    for (const auto &[name, id] : nodes[node].children) {
+      if (name == key)
+        return id;
+    }
+    // a JSON-LD value object stands for the field it sits in
+    if (key == "@value" && nodes[node].column >= 0)
+      return node;
+    return NONE;
+  }
+
+  int column(int node) const {
+    return node == NONE ? -1 : nodes[node].column;
+  }
+
+private:
+  struct Node {
+    vector<pair<string_view, int>> children;
+    int column = -1;
+  };
+  vector<Node> nodes;
+};
+
+// The fields of one measurement, as raw JSON text
+struct Item {
+  array<string_view, COLUMN_COUNT> fields;
+  ColumnSet present;
+  // where fields with escapes were unescaped to
+  array<string, COLUMN_COUNT> unescaped;
+};
+
+// Pull parser over the mapped file; only the fields of `tree` are decoded,
+// everything else is stepped over
+class JsonReader {
+public:
+  JsonReader(string_view data, const FieldTree &tree)
+      : data(data), limit(data.data() + data.size()), tree(tree) {}
+
+  // Offset of the first measurement (or the closing ] of an empty array)
+  size_t findItems() {
+    p = data.data();
+    if (data.substr(0, 3) == "\xEF\xBB\xBF")
+      p += 3;
+    blank();
+    if (p < limit && *p == '[') {
+      p++;
+      blank();
+      return offset();
+    }
+    expect('{');
+    blank();
+    while (p < limit && *p == '"') {
+      auto key = str(&keyScratch);
+      blank();
+      expect(':');
+      blank();
+      if ((key == "items" || key == "@graph") && p < limit && *p == '[') {
+        p++;
+        blank();
+        return offset();
+      }
+      skipValue();
+      blank();
+      if (p == limit || *p != ',')
+        break;
+      p++;
+      blank();
+    }
+    throw runtime_error(
+        "No measurements (an \"items\" or \"@graph\" array) in the JSON");
+  }
+
+  // Reads the measurement at `pos` into `item` and moves `pos` past it.
+  // Returns false at `end` or at the array's closing ].
+  bool next(size_t &pos, size_t end, Item &item) {
+    p = data.data() + pos;
+    blank();
+    if (offset() >= end || p == limit || *p == ']')
+      return false;
+    if (*p != '{')
+      throw malformed("a measurement object");
+    item.present.reset();
+    object(0, item);
+    blank();
+    if (p < limit && *p == ',')
+      p++;
+    else if (p == limit || *p != ']')
+      throw malformed("',' or ']'");
+    pos = offset();
+    return true;
+  }
+
+  runtime_error malformed(const char *expected) const {
+    return runtime_error("Malformed JSON at byte " + to_string(offset()) +
+                         ": expected " + expected);
+  }
+
+private:
+  size_t offset() const { return p - data.data(); }
+
+  void blank() {
+    while (p < limit &&
+           (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+      p++;
+  }
+
+  void expect(char c) {
+    if (p == limit || *p != c)
+      throw malformed(string{'\'', c, '\''}.c_str());
+    p++;
+  }
+
+  void value(int node, Item &item) {
+    blank();
+    if (p == limit)
+      throw malformed("a value");
+    int column = tree.column(node);
+    // the first of repeated fields wins, its text may be in `unescaped`
+    if (node == FieldTree::NONE || (column >= 0 && item.present[column])) {
+      skipValue();
+      return;
+    }
+    if (*p == '{') {
+      object(node, item);
+      return;
+    }
+    if (*p == '[') {
+      list(node, item);
+      return;
+    }
+    if (column < 0) {
+      skipValue();
+      return;
+    }
+
+    string_view text;
+    if (*p == '"') {
+      text = str(&item.unescaped[column]);
+    } else {
+      text = literal();
+      if (text == "null")
+        return;
+    }
+    item.fields[column] = text;
+    item.present.set(column);
+  }
+
+  void object(int node, Item &item) {
+    p++;
+    blank();
+    if (p < limit && *p == '}') {
+      p++;
+      return;
+    }
+    while (true) {
+      blank();
+      if (p == limit || *p != '"')
+        throw malformed("a key");
+      auto key = str(&keyScratch);
+      blank();
+      expect(':');
+      value(tree.child(node, key), item);
+      blank();
+      if (p < limit && *p == ',') {
+        p++;
+        continue;
+      }
+      expect('}');
+      return;
+    }
+  }
+
+  // of several values the first is taken, nested arrays are not followed
+  void list(int node, Item &item) {
+    p++;
+    blank();
+    if (p < limit && *p == ']') {
+      p++;
+      return;
+    }
+    for (bool first = true;; first = false) {
+      blank();
+      if (first && p < limit && *p != '[')
+        value(node, item);
+      else
+        skipValue();
+      blank();
+      if (p < limit && *p == ',') {
+        p++;
+        continue;
+      }
+      expect(']');
+      return;
+    }
+  }
+
+  // The string at p. Most have no escapes and are returned in place; the
+  // rest are unescaped into `scratch`.
+  string_view str(string *scratch) {
+    const char *begin = ++p;
+    auto quote = (const char *)memchr(p, '"', limit - p);
+    if (!quote)
+      throw malformed("a closing quote");
+    if (!memchr(begin, '\\', quote - begin)) {
+      p = quote + 1;
+      return string_view(begin, quote - begin);
+    }
+
+    scratch->clear();
+    while (true) {
+      if (p == limit)
+        throw malformed("a closing quote");
+      char c = *p++;
+      if (c == '"')
+        break;
+      if (c != '\\') {
+        scratch->push_back(c);
+        continue;
+      }
+      if (p == limit)
+        throw malformed("an escape sequence");
+      switch (char e = *p++) {
+      case '"':
+      case '\\':
+      case '/':
+        scratch->push_back(e);
+        break;
+      case 'b':
+        scratch->push_back('\b');
+        break;
+      case 'f':
+        scratch->push_back('\f');
+        break;
+      case 'n':
+        scratch->push_back('\n');
+        break;
+      case 'r':
+        scratch->push_back('\r');
+        break;
+      case 't':
+        scratch->push_back('\t');
+        break;
+      case 'u': {
+        uint32_t code = hex4();
+        // a surrogate pair is one character
+        if (code >= 0xD800 && code < 0xDC00 && limit - p >= 6 &&
+            p[0] == '\\' && p[1] == 'u') {
+          p += 2;
+          uint32_t low = hex4();
+          if (low >= 0xDC00 && low < 0xE000) {
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+          } else {
+            appendUtf8(*scratch, code);
+            code = low;
+          }
+        }
+        appendUtf8(*scratch, code);
+        break;
+      }
+      default:
+        throw malformed("an escape sequence");
+      }
+    }
+    return *scratch;
+  }
+
+  uint32_t hex4() {
+    if (limit - p < 4)
+      throw malformed("four hex digits");
+    uint32_t code = 0;
+    for (int i = 0; i < 4; i++, p++) {
+      char c = *p;
+      int digit = c >= '0' && c <= '9'   ? c - '0'
+                  : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                  : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                         : -1;
+      if (digit < 0)
+        throw malformed("four hex digits");
+      code = code << 4 | digit;
+    }
+    return code;
+  }
+
+  static void appendUtf8(string &out, uint32_t code) {
+    if (code < 0x80) {
+      out.push_back(code);
+    } else if (code < 0x800) {
+      out.push_back(0xC0 | code >> 6);
+      out.push_back(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+      out.push_back(0xE0 | code >> 12);
+      out.push_back(0x80 | (code >> 6 & 0x3F));
+      out.push_back(0x80 | (code & 0x3F));
+    } else {
+      out.push_back(0xF0 | code >> 18);
+      out.push_back(0x80 | (code >> 12 & 0x3F));
+      out.push_back(0x80 | (code >> 6 & 0x3F));
+      out.push_back(0x80 | (code & 0x3F));
+    }
+  }
+
+  // a number, true, false or null; checked by whoever reads it
+  string_view literal() {
+    const char *begin = p;
+    while (p < limit && (isalnum((unsigned char)*p) || *p == '-' ||
+                         *p == '+' || *p == '.'))
+      p++;
+    if (p == begin)
+      throw malformed("a value");
+    return string_view(begin, p - begin);
+  }
+
+  void skipString() {
+    const char *quote = p + 1;
+    while (true) {
+      quote = (const char *)memchr(quote, '"', limit - quote);
+      if (!quote)
+        throw malformed("a closing quote");
+      // a quote after an odd run of backslashes is escaped
+      const char *run = quote;
+      while (run[-1] == '\\')
+        run--;
+      if ((quote - run) % 2 == 0)
+        break;
+      quote++;
+    }
+    p = quote + 1;
+  }
+
+  void skipValue() {
+    blank();
+    if (p == limit)
+      throw malformed("a value");
+    if (*p == '"') {
+      skipString();
+      return;
+    }
+    if (*p != '{' && *p != '[') {
+      literal();
+      return;
+    }
+    size_t depth = 0;
+    do {
+      char c = *p;
+      if (c == '"') {
+        skipString();
+        continue;
+      }
+      if (c == '{' || c == '[')
+        depth++;
+      else if (c == '}' || c == ']')
+        depth--;
+      p++;
+    } while (depth > 0 && p < limit);
+    if (depth > 0)
+      throw malformed("the end of a value");
+  }
+
+  string_view data;
+  const char *limit;
+  const char *p = nullptr;
+  const FieldTree &tree;
+  string keyScratch;
+};
+
+// Where a byte of the measurement array is: inside a string or not, and
+// how deeply nested below the measurements themselves
+struct ScanState {
+  bool inString = false;
+  long depth = 0;
+};
+
+// whether data[pos] follows an odd run of backslashes
+static bool escapedAt(string_view data, size_t pos) {
+  size_t run = pos;
+  while (run > 0 && data[run - 1] == '\\')
+    run--;
+  return (pos - run) % 2;
+}
+
+// First unescaped quote in data[pos, end), or end
+static size_t nextQuote(string_view data, size_t pos, size_t end) {
+  while (pos < end) {
+    auto quote = (const char *)memchr(data.data() + pos, '"', end - pos);
+    if (!quote)
+      return end;
+    size_t at = quote - data.data();
+    if (!escapedAt(data, at))
+      return at;
+    pos = at + 1;
+  }
+  return end;
+}
+
+// Quotes are everywhere in JSON and backslashes rare, so every quote is
+// counted and then the escaped ones are taken off
+static size_t countQuotes(string_view data, size_t begin, size_t end) {
+  size_t quotes = count(data.begin() + begin, data.begin() + end, '"');
+  if (begin < end && data[begin] == '"' && escapedAt(data, begin))
+    quotes--;
+  size_t pos = begin;
+  while (pos < end) {
+    auto slash = (const char *)memchr(data.data() + pos, '\\', end - pos);
+    if (!slash)
+      break;
+    pos = slash - data.data();
+    while (pos < end && data[pos] == '\\')
+      pos++;
+    if (pos < end && data[pos] == '"' && escapedAt(data, pos))
+      quotes--;
+  }
+  return quotes;
+}
+
+// +1 for a byte that opens an object or array, -1 for one that closes it
+static const array<signed char, 256> NESTING = [] {
+  array<signed char, 256> nesting{};
+  nesting['{'] = nesting['['] = 1;
+  nesting['}'] = nesting[']'] = -1;
+  return nesting;
+}();
+
+// The change in depth over data[pos, end), starting in a string or not;
+// `inString` is left as it is at `end`
+static long nesting(string_view data, size_t pos, size_t end, bool &inString) {
+  const char *p = data.data() + pos, *stop = data.data() + end;
+  if (inString && p < stop && escapedAt(data, pos))
+    p++;
+  long depth = 0;
+  for (; p < stop; p++) {
+    char c = *p;
+    if (inString) {
+      if (c == '\\')
+        p++;
+      else if (c == '"')
+        inString = false;
+    } else if (c == '"') {
+      inString = true;
+    } else {
+      depth += NESTING[(unsigned char)c];
+    }
+  }
+  return depth;
+}
+
+// The first measurement to start at or after `pos`, or the ] that closes
+// the array, given the state at `pos`; past the array's end, data.size().
+static size_t nextItem(string_view data, size_t pos, ScanState state) {
+  if (state.depth < 0)
+    return data.size();
+  while (pos < data.size()) {
+    if (state.inString) {
+      pos = nextQuote(data, pos, data.size());
+      if (pos == data.size())
+        break;
+      state.inString = false;
+      pos++;
+      continue;
+    }
+    char c = data[pos];
+    if (c == '"')
+      state.inString = true;
+    else if (NESTING[(unsigned char)c] != 0 && state.depth == 0)
+      return pos;
+    else
+      state.depth += NESTING[(unsigned char)c];
+    pos++;
+  }
+  return data.size();
+}
+
+// Cuts the measurements in data[begin, end) into `parts` slices that each
+// start on a measurement, the last one running on to the start of the
+// measurement after `end`. `begin` must start a measurement. Quote parity
+// and then nesting are counted per nominal slice in parallel, which gives
+// the state at each nominal cut; from there it is a short scan to the next
+// measurement.
+static vector<size_t> splitItems(string_view data, size_t begin, size_t end,
+                                 size_t parts) {
+  // a single slice to the end of the file has nothing to look for
+  if (parts == 1 && end == data.size())
+    return {begin, end};
+
+  size_t size = end - begin;
+  vector<size_t> nominal(parts + 1);
+  for (size_t i = 0; i <= parts; i++)
+    nominal[i] = begin + size * i / parts;
+
+  // both passes go a window at a time, giving the pages back once read
+  auto windows = [&](size_t i, auto read) {
+    ReadBehind behind(data, nominal[i], nominal[i + 1]);
+    for (size_t at = nominal[i]; at < nominal[i + 1];) {
+      size_t stop = min(nominal[i + 1], at + ReadBehind::WINDOW_BYTES);
+      read(at, stop);
+      behind.reached(stop);
+      at = stop;
+    }
+  };
+
+  vector<size_t> quotes(parts, 0);
+  runParallel(parts, [&](size_t i) {
+    windows(i, [&](size_t at, size_t stop) {
+      quotes[i] += countQuotes(data, at, stop);
+    });
+  });
+  vector<ScanState> states(parts + 1);
+  size_t before = 0;
+  for (size_t i = 0; i <= parts; i++) {
+    states[i].inString = before % 2;
+    if (i < parts)
+      before += quotes[i];
+  }
+
+  vector<long> depths(parts, 0);
+  runParallel(parts, [&](size_t i) {
+    bool inString = states[i].inString;
+    windows(i, [&](size_t at, size_t stop) {
+      depths[i] += nesting(data, at, stop, inString);
+    });
+  });
+  long depth = 0;
+  for (size_t i = 0; i <= parts; i++) {
+    states[i].depth = depth;
+    if (i < parts)
+      depth += depths[i];
+  }
+
+  auto cutAt = [&](size_t i) { return nextItem(data, nominal[i], states[i]); };
+  size_t last = end < data.size() ? cutAt(parts) : data.size();
+  vector<size_t> cuts{begin};
+  for (size_t i = 1; i < parts; i++) {
+    size_t cut = cutAt(i);
+    if (cut > cuts.back() && cut < last)
+      cuts.push_back(cut);
+  }
+  cuts.push_back(last);
+  return cuts;
+}
+
+// Adds the measurements in data[begin, end) to `store` like the csv
+// loader's ingestRows adds rows, giving back the pages of `data` (the
+// mapped file) as it goes. `mapped` is the mapping when the store may
+// borrow text from it.
+static void ingestItems(string_view data, size_t begin, size_t end,
+                        const FieldTree &tree, ColumnStore &store,
+                        SliceProgress &progress, const LoadSpec &spec,
+                        string_view mapped) {
+  auto &pool = store.strings;
+  TimestampParser timestamps;
+  RowFilter filter(spec);
+  auto kept = spec.keptColumns();
+  JsonReader reader(data, tree);
+  Item item;
+  // the point and sample of the previous measurement kept
+  int p = -1, s = -1;
+  ReadBehind behind(data, begin, end);
+  size_t pos = begin;
+  for (size_t at = pos; reader.next(pos, end, item); at = pos) {
+    behind.reached(at);
+    auto raw = [&](Column column) {
+      return item.present[(size_t)column] ? item.fields[(size_t)column]
+                                          : string_view();
+    };
+    auto bad = [&](Column column, const char *problem) {
+      return runtime_error("Measurement at byte " + to_string(at) + " " +
+                           problem + " " + COLUMN_NAMES[(size_t)column]);
+    };
+    for (auto column : {Column::SamplingPointNotation, Column::SampleDateTime,
+                        Column::DeterminandNotation, Column::Result}) {
+      if (!item.present[(size_t)column])
+        throw bad(column, "has no");
+    }
+
+    if (filter.active() &&
+        !(filter.keepPoint(raw(Column::SamplingPointNotation)) &&
+          filter.keepTime(raw(Column::SampleDateTime)) &&
+          filter.keepDeterminand(raw(Column::DeterminandNotation),
+                                 raw(Column::DeterminandLabel)))) {
+      progress.row();
+      continue;
+    }
+
+    // fields projected away read as empty
+    auto text = [&](Column column) {
+      return kept[(size_t)column] ? raw(column) : string_view();
+    };
+    // unescaped fields live in the item, not the mapping
+    auto intern = [&](Column column) {
+      auto value = text(column);
+      auto from = reinterpret_cast<uintptr_t>(value.data());
+      auto start = reinterpret_cast<uintptr_t>(mapped.data());
+      bool borrow = !mapped.empty() && from >= start &&
+                    from + value.size() <= start + mapped.size();
+      return pool.intern(value, borrow);
+    };
+    // coordinates may be written as 514500.0
+    auto integer = [&](Column column) {
+      int value;
+      double real;
+      auto field = text(column);
+      if (field.empty() || parseInt(field, value))
+        return field.empty() ? 0 : value;
+      if (!parseDouble(field, real))
+        throw bad(column, "has a non-numeric");
+      // false for NaN as well
+      if (!(real >= numeric_limits<int>::min() &&
+            real <= numeric_limits<int>::max()))
+        throw bad(column, "has an out of range");
+      return (int)real;
+    };
+
+    // as in the csv loader, a run of measurements of one sample is told by
+    // its keys' text alone
+    if (p < 0 || text(Column::SamplingPointNotation) !=
+                     pool.str(store.pointNotation[p])) {
+      auto samplingPoint = intern(Column::SamplingPointNotation);
+      auto northing = integer(Column::SamplingPointNorthing);
+      auto easting = integer(Column::SamplingPointEasting);
+      auto samplingPointLabel = intern(Column::SamplingPointLabel);
+      p = store.findPoint(samplingPoint);
+      if (p < 0) {
+        p = store.addPoint(samplingPoint, northing, easting,
+                           samplingPointLabel);
+      }
+      s = -1;
+    }
+
+    if (s < 0 ||
+        text(Column::SampleDateTime) != pool.str(store.sampleDateTime[s])) {
+      auto samplePurposeLabel = intern(Column::SamplePurpose);
+      auto materialType = intern(Column::SampledMaterialType);
+      auto datetime = intern(Column::SampleDateTime);
+      s = store.findSample(p, datetime);
+      if (s < 0) {
+        auto time = timestamps.parse(pool.str(datetime));
+        bool isComp = text(Column::IsComplianceSample) == "true";
+        s = store.addSample(p, isComp, samplePurposeLabel, datetime,
+                            time.value_or(ColumnStore::NO_TIME), materialType);
+      }
+    }
+
+    auto determinandNotation = intern(Column::DeterminandNotation);
+    double result;
+    if (!parseDouble(text(Column::Result), result))
+      throw bad(Column::Result, "has a non-numeric");
+
+    int d = store.findDeterminand(determinandNotation);
+    if (d < 0) {
+      auto determinandLabel = intern(Column::DeterminandLabel);
+      auto determinandDef = intern(Column::DeterminandDefinition);
+      auto determinandUnitLabel = intern(Column::DeterminandUnitLabel);
+      d = store.addDeterminand(determinandLabel, determinandDef,
+                               determinandNotation, determinandUnitLabel);
+    }
+
+    store.addRow(s, d, result);
+    progress.row();
+  }
+  progress.done();
+}
+
+bool isJsonFile(const string &filename) {
+  ifstream file(filename, ios::binary);
+  if (!file)
+    throw runtime_error("Unable to open " + filename);
+  char head[64];
+  file.read(head, sizeof(head));
+  string_view text(head, file.gcount());
+  if (text.substr(0, 3) == "\xEF\xBB\xBF")
+    text.remove_prefix(3);
+  size_t first = text.find_first_not_of(" \t\r\n");
+  return first != string_view::npos &&
+         (text[first] == '{' || text[first] == '[');
+}
+
+void loadJsonFile(const string &filename, ColumnStore &store,
+                  const CsvLoadOptions &options) {
+  auto progress = options.progress;
+  const auto &onPartial = options.onPartial;
+  error_code error;
+  // shared with every pool that borrows text from it
+  auto file = make_shared<const mio::mmap_source>(
+      mio::make_mmap_source(filename, error));
+  if (error)
+    throw runtime_error("Unable to open " + filename + ": " + error.message());
+  string_view data(file->data(), file->size());
+  if (progress)
+    progress->totalBytes.fetch_add(data.size(), memory_order_relaxed);
+
+  FieldTree tree;
+  size_t itemsBegin = JsonReader(data, tree).findItems();
+
+  size_t threads = parallelism();
+  vector<ColumnStore> slices;
+  size_t begin = itemsBegin;
+  // rounds double like the csv loader's, see csv_loader.hpp
+  size_t roundBytes = csv::internals::ITERATION_CHUNK_SIZE;
+  while (begin < data.size() && data[begin] != ']') {
+    size_t end = onPartial ? min(data.size(), begin + roundBytes) : data.size();
+    size_t parts =
+        min(threads, max<size_t>(1, (end - begin) / MIN_SLICE_BYTES));
+    auto cuts = splitItems(data, begin, end, parts);
+    parts = cuts.size() - 1;
+
+    vector<ColumnStore> partial(parts);
+    runParallel(parts, [&](size_t i) {
+      partial[i].reserveRows((cuts[i + 1] - cuts[i]) / ESTIMATED_ITEM_BYTES);
+      if (options.mapText)
+        partial[i].strings.keepAlive(file);
+      SliceProgress sliceProgress(progress, cuts[i + 1] - cuts[i],
+                                  ESTIMATED_ITEM_BYTES);
+      ingestItems(data, cuts[i], cuts[i + 1], tree, partial[i], sliceProgress,
+                  options.spec, options.mapText ? data : string_view());
+    });
+    if (progress && progress->isCancelled())
+      throw LoadCancelled();
+
+    for (auto &slice : partial)
+      slices.push_back(std::move(slice));
+
+    begin = cuts.back();
+    if (onPartial && begin < data.size() && data[begin] != ']') {
+      auto copy = slices;
+      onPartial(
+          ColumnStore::mergeAll(copy, options.spec.duplicates, threads));
+      roundBytes *= 2;
+    }
+  }
+  // everything around the measurements counts as read with them
+  if (progress)
+    progress->bytes.fetch_add(data.size() - begin + itemsBegin,
+                              memory_order_relaxed);
+
+  store = ColumnStore::mergeAll(slices, options.spec.duplicates, threads);
+}
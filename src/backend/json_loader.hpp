@@ -0,0 +1,37 @@
+// Parallel streaming ingest of EA water quality JSON and JSON-LD exports
+
+#pragma once
+
+#include "column_store.hpp"
+#include "csv_loader.hpp"
+#include <string>
+
+/*
+ * The EA linked-data API returns measurements as {"meta": ..., "items":
+ * [...]}, JSON-LD dumps hold them in "@graph", and a bare top-level array
+ * works too. Each measurement is an object whose fields sit at the paths
+ * the csv export uses as column names (sample.samplingPoint.notation and so
+ * on, see water_schema.hpp); everything else in it is skipped unread.
+ * JSON-LD's {"@value": v} wrappers are unwrapped, and of an array of values
+ * the first is taken.
+ *
+ * No document is built. The file is mapped and the measurement array cut
+ * into one slice per core, each starting on a measurement: like the csv
+ * loader's quote parity, two parallel passes count the unescaped quotes and
+ * then the nesting of each nominal slice, which gives the state at every
+ * cut. Each slice is then read value by value (a pull parser, so the row
+ * being built is the only state) into its own ColumnStore, and the stores
+ * are built into one in file order by ColumnStore::mergeAll().
+ *
+ * `options` work as for loadCsvFile, mapText included: strings without
+ * escapes are kept in the mapping. A measurement lacking any of the fields
+ * rows are keyed on, or its result, is an error; other missing fields read
+ * as they do for a column the LoadSpec leaves out. Throws
+ * std::runtime_error, with the byte offset, on malformed JSON.
+ */
+
+// true if the file's first non-blank byte opens a JSON object or array
+bool isJsonFile(const std::string &filename);
+
+void loadJsonFile(const std::string &filename, ColumnStore &store,
+                  const CsvLoadOptions &options = {});
@@ -0,0 +1,81 @@
+// Progress and cancellation shared between a loading thread and the GUI
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+
+/*
+ * The loader only ever adds to the counters and checks `cancelled`; the GUI
+ * polls the counters and may call cancel() at any time. Everything is a
+ * relaxed atomic, the numbers are only for display.
+ */
+class LoadProgress {
+public:
+  void reset() {
+    totalBytes.store(0, std::memory_order_relaxed);
+    bytes.store(0, std::memory_order_relaxed);
+    rows.store(0, std::memory_order_relaxed);
+    cancelled.store(false, std::memory_order_relaxed);
+  }
+
+  void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+  bool isCancelled() const {
+    return cancelled.load(std::memory_order_relaxed);
+  }
+
+  std::atomic<size_t> totalBytes{0};
+  std::atomic<size_t> bytes{0};
+  std::atomic<size_t> rows{0};
+
+private:
+  std::atomic<bool> cancelled{false};
+};
+
+// thrown out of a load once its LoadProgress has been cancelled
+class LoadCancelled : public std::runtime_error {
+public:
+  LoadCancelled() : std::runtime_error("Loading was cancelled") {}
+};
+
+// Reports a loader slice's rows to the shared progress in batches. The
+// parsers do not expose their offset, so bytes are estimated from the row
+// count at `rowBytes` a row and settled to the slice's exact size once it is
+// done. Throws LoadCancelled from row() soon after the load is cancelled.
+class SliceProgress {
+public:
+  // rows between progress updates and cancellation checks
+  static constexpr size_t ROWS_PER_REPORT = 4096;
+
+  SliceProgress(LoadProgress *progress, size_t sliceBytes, size_t rowBytes)
+      : progress(progress), sliceBytes(sliceBytes), rowBytes(rowBytes) {}
+
+  void row() {
+    if (!progress || ++pending < ROWS_PER_REPORT)
+      return;
+    if (progress->isCancelled())
+      throw LoadCancelled();
+    flush(std::min(pending * rowBytes, sliceBytes - reported));
+  }
+
+  void done() {
+    if (progress)
+      flush(sliceBytes - reported);
+  }
+
+private:
+  void flush(size_t bytes) {
+    progress->rows.fetch_add(pending, std::memory_order_relaxed);
+    progress->bytes.fetch_add(bytes, std::memory_order_relaxed);
+    reported += bytes;
+    pending = 0;
+  }
+
+  LoadProgress *progress;
+  size_t sliceBytes;
+  size_t rowBytes;
+  size_t reported = 0;
+  size_t pending = 0;
+};
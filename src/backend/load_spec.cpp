@@ -0,0 +1,81 @@
+#include "load_spec.hpp"
+#include <algorithm>
+#include <cctype>
+
+using namespace std;
+
+static ColumnSet alwaysKept() {
+  ColumnSet kept;
+  kept.set((size_t)Column::SamplingPointNotation);
+  kept.set((size_t)Column::SampleDateTime);
+  kept.set((size_t)Column::DeterminandNotation);
+  kept.set((size_t)Column::Result);
+  return kept;
+}
+
+static string lower(string_view text) {
+  string out(text);
+  for (char &c : out)
+    c = tolower((unsigned char)c);
+  return out;
+}
+
+bool LoadSpec::keepsEverything() const {
+  return columns.all() && !from && !to && points.empty() &&
+         determinands.empty() && determinandKeywords.empty() &&
+         duplicates == DuplicatePolicy::KeepFirst;
+}
+
+ColumnSet LoadSpec::keptColumns() const { return columns | alwaysKept(); }
+
+ColumnSet LoadSpec::readColumns() const {
+  auto read = keptColumns();
+  if (!determinandKeywords.empty())
+    read.set((size_t)Column::DeterminandLabel);
+  return read;
+}
+
+RowFilter::RowFilter(const LoadSpec &spec)
+    : spec(spec), filtering(spec.from || spec.to || !spec.points.empty() ||
+                            !spec.determinands.empty() ||
+                            !spec.determinandKeywords.empty()) {
+  for (const auto &point : spec.points)
+    points.intern(point);
+  for (const auto &keyword : spec.determinandKeywords)
+    keywords.push_back(lower(keyword));
+}
+
+bool RowFilter::keepPoint(string_view notation) const {
+  return spec.points.empty() || points.find(notation) >= 0;
+}
+
+bool RowFilter::keepTime(string_view dateTime) {
+  if (!spec.from && !spec.to)
+    return true;
+  if (dateTime == lastDateTime)
+    return lastTimeKept;
+
+  auto time = timestamps.parse(dateTime);
+  lastDateTime = dateTime;
+  lastTimeKept = time && (!spec.from || *time >= *spec.from) &&
+                 (!spec.to || *time < *spec.to);
+  return lastTimeKept;
+}
+
+bool RowFilter::keepDeterminand(string_view notation, string_view label) {
+  if (spec.determinands.empty() && keywords.empty())
+    return true;
+  int seen = determinands.find(notation);
+  if (seen >= 0)
+    return keptDeterminands[seen];
+
+  bool kept = find(spec.determinands.begin(), spec.determinands.end(),
+                   notation) != spec.determinands.end();
+  auto text = lower(label);
+  for (const auto &keyword : keywords)
+    kept = kept || text.find(keyword) != string::npos;
+
+  determinands.intern(notation);
+  keptDeterminands.push_back(kept);
+  return kept;
+}
@@ -0,0 +1,74 @@
+// Which rows and columns of a csv a load keeps
+
+#pragma once
+
+#include "column_store.hpp"
+#include "string_pool.hpp"
+#include "timestamp.hpp"
+#include "water_schema.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * A LoadSpec narrows a load to what a session needs: one region, one year,
+ * only PFAS determinands... The loader checks it against each row's raw
+ * field text before anything is interned or added to the store, so a row
+ * that is skipped costs only its tokenizing. A default LoadSpec keeps
+ * everything.
+ *
+ * Columns left out of `columns` are not read and need not be in the file:
+ * their text is stored empty, northing/easting as 0 and isComplianceSample
+ * as false. The columns rows are keyed on (point notation, sample datetime,
+ * determinand notation) and result are always kept.
+ *
+ * `duplicates` decides which of a set of repeated rows stays (see
+ * column_store.hpp).
+ */
+struct LoadSpec {
+  ColumnSet columns = ColumnSet().set();
+  // sample times in [from, to), ms since the epoch like
+  // ColumnStore::sampleTime; samples without a valid time are dropped once
+  // either bound is set
+  std::optional<int64_t> from, to;
+  // sampling point notations to keep, empty keeps every point
+  std::vector<std::string> points;
+  // determinands to keep, by notation or by a word their label contains
+  // (ignoring ASCII case); both empty keeps every determinand
+  std::vector<std::string> determinands;
+  std::vector<std::string> determinandKeywords;
+  DuplicatePolicy duplicates = DuplicatePolicy::KeepFirst;
+
+  bool keepsEverything() const;
+  // `columns` plus the ones that are always kept
+  ColumnSet keptColumns() const;
+  // the columns a load has to bind, kept ones and whatever the filters read
+  ColumnSet readColumns() const;
+};
+
+// The row filter of a LoadSpec, with lookups and caches for one thread
+class RowFilter {
+public:
+  explicit RowFilter(const LoadSpec &spec);
+
+  // false if the spec has no row filter at all
+  bool active() const { return filtering; }
+  bool keepPoint(std::string_view notation) const;
+  bool keepTime(std::string_view dateTime);
+  bool keepDeterminand(std::string_view notation, std::string_view label);
+
+private:
+  const LoadSpec &spec;
+  bool filtering;
+  StringPool points;
+  TimestampParser timestamps;
+  // rows of a sample come together, so the last verdict is reused
+  std::string lastDateTime;
+  bool lastTimeKept = false;
+  // determinand notations seen so far and whether each is kept
+  StringPool determinands;
+  std::vector<bool> keptDeterminands;
+  std::vector<std::string> keywords; // lower case
+};
@@ -0,0 +1,95 @@
+#include "numbers.hpp"
+#include <charconv>
+#include <cstdint>
+
+using namespace std;
+
+// powers of ten that are exact in a double
+static const double POW10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                               1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                               1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                               1e18, 1e19, 1e20, 1e21, 1e22};
+static const int MAX_EXACT_POW10 = 22;
+static const uint64_t MAX_EXACT_MANTISSA = uint64_t(1) << 53;
+static const int MAX_DIGITS = 19;
+
+static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+bool parseDouble(string_view text, double &value) {
+  size_t i = 0, n = text.size();
+  bool negative = false;
+  if (i < n && (text[i] == '-' || text[i] == '+'))
+    negative = text[i++] == '-';
+
+  uint64_t mantissa = 0;
+  int digits = 0, seen = 0, exponent = 0;
+  bool exact = true;
+  auto digit = [&](char c, bool fraction) {
+    seen++;
+    if (mantissa == 0 && c == '0') {
+      // leading zeros are not significant
+      exponent -= fraction;
+      return;
+    }
+    if (digits == MAX_DIGITS) {
+      exact = false;
+      exponent += !fraction;
+      return;
+    }
+    mantissa = mantissa * 10 + (c - '0');
+    digits++;
+    exponent -= fraction;
+  };
+
+  for (; i < n && isDigit(text[i]); i++)
+    digit(text[i], false);
+  if (i < n && text[i] == '.') {
+    for (i++; i < n && isDigit(text[i]); i++)
+      digit(text[i], true);
+  }
+  if (seen == 0)
+    return false;
+
+  if (i < n && (text[i] == 'e' || text[i] == 'E')) {
+    i++;
+    bool negativeExponent = false;
+    if (i < n && (text[i] == '-' || text[i] == '+'))
+      negativeExponent = text[i++] == '-';
+    if (i == n || !isDigit(text[i]))
+      return false;
+    int written = 0;
+    for (; i < n && isDigit(text[i]); i++) {
+      // anything this large is out of range either way
+      if (written < 100000)
+        written = written * 10 + (text[i] - '0');
+    }
+    exponent += negativeExponent ? -written : written;
+  }
+  if (i != n)
+    return false;
+
+  // Clinger's fast path: both operands are exact, so the single IEEE
+  // multiplication or division is correctly rounded
+  if (exact && mantissa <= MAX_EXACT_MANTISSA &&
+      exponent >= -MAX_EXACT_POW10 && exponent <= MAX_EXACT_POW10) {
+    double m = double(mantissa);
+    value = exponent < 0 ? m / POW10[-exponent] : m * POW10[exponent];
+    if (negative)
+      value = -value;
+    return true;
+  }
+
+#if defined(__cpp_lib_to_chars)
+  // the grammar was checked above, so this never sees nan or inf
+  const char *begin = text.data() + (text[0] == '+');
+  auto result = from_chars(begin, text.data() + n, value);
+  return result.ec == errc() && result.ptr == text.data() + n;
+#else
+  return false;
+#endif
+}
+
+bool parseInt(string_view text, int &value) {
+  auto result = from_chars(text.data(), text.data() + text.size(), value);
+  return result.ec == errc() && result.ptr == text.data() + text.size();
+}
@@ -0,0 +1,23 @@
+// Fast parsing of the numeric columns (result, easting, northing)
+
+#pragma once
+
+#include <string_view>
+
+/*
+ * CSVField::get<double>() detects the field's type first and accumulates the
+ * digits in a long double, which costs time and can round the last bit
+ * wrongly. The columns the loader reads as numbers are known to be numeric,
+ * so these parse plain decimal text directly and return false for anything
+ * else (leading/trailing spaces, hex, nan, ...), which the caller hands to
+ * CSVField as before.
+ */
+
+// [+-]digits[.digits][(e|E)[+-]digits], correctly rounded. Values with at
+// most 19 significant digits and a power of ten within 1e±22 (every result
+// in an EA export) take an exact fast path; the rest use std::from_chars
+// where the standard library has it.
+bool parseDouble(std::string_view text, double &value);
+
+// [-]digits that fit an int
+bool parseInt(std::string_view text, int &value);
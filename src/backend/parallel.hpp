@@ -0,0 +1,87 @@
+// Fork/join and producer/consumer helpers shared by the loaders
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// One thread per core, or one if the count is unknown
+inline size_t parallelism() {
+  return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+// Runs task(0) .. task(count - 1) on their own threads and rethrows the
+// first exception any of them threw.
+template <typename Task> void runParallel(size_t count, Task task) {
+  if (count == 1) {
+    task(0);
+    return;
+  }
+
+  std::vector<std::exception_ptr> errors(count);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < count; i++) {
+    threads.emplace_back([&, i] {
+      try {
+        task(i);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+  for (auto &error : errors) {
+    if (error)
+      std::rethrow_exception(error);
+  }
+}
+
+// Blocking queue of at most `capacity` items between a producer and a
+// consumer thread. Either side may close() it: push() then returns false at
+// once, and pop() returns false once what was already queued is taken.
+template <typename T> class BoundedQueue {
+public:
+  explicit BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+  bool push(T item) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notFull.wait(lock, [&] { return closed || items.size() < capacity; });
+    if (closed)
+      return false;
+    items.push_back(std::move(item));
+    notEmpty.notify_one();
+    return true;
+  }
+
+  bool pop(T &item) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notEmpty.wait(lock, [&] { return closed || !items.empty(); });
+    if (items.empty())
+      return false;
+    item = std::move(items.front());
+    items.pop_front();
+    notFull.notify_one();
+    return true;
+  }
+
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    notFull.notify_all();
+    notEmpty.notify_all();
+  }
+
+private:
+  size_t capacity;
+  std::mutex mutex;
+  std::condition_variable notFull, notEmpty;
+  std::deque<T> items;
+  bool closed = false;
+};
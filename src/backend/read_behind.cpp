@@ -0,0 +1,39 @@
+#include "read_behind.hpp"
+#include <algorithm>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+ReadBehind::ReadBehind(string_view mapping, size_t begin, size_t end)
+    : mapping(mapping), released(begin), next(begin + WINDOW_BYTES),
+      end(min(end, mapping.size())) {
+  if (mapping.empty())
+    next = SIZE_MAX;
+}
+
+ReadBehind::~ReadBehind() {
+  if (!mapping.empty())
+    release(end);
+}
+
+void ReadBehind::release(size_t pos) {
+  pos = min(pos, end);
+#ifndef _WIN32
+  static const uintptr_t PAGE = sysconf(_SC_PAGESIZE);
+  // whole pages only; the one `pos` is in goes with the next window
+  auto base = reinterpret_cast<uintptr_t>(mapping.data());
+  uintptr_t first = (base + released + PAGE - 1) & ~(PAGE - 1);
+  uintptr_t last = (base + pos) & ~(PAGE - 1);
+  if (first < last) {
+    madvise(reinterpret_cast<void *>(first), last - first, MADV_DONTNEED);
+    released = last - base;
+  }
+#else
+  released = pos;
+#endif
+  next = pos + WINDOW_BYTES;
+}
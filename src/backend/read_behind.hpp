@@ -0,0 +1,60 @@
+// Giving back the pages of a mapped file once a loader has read past them
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/*
+ * Every page of a mapping that a loader touches stays resident in the
+ * process, so without this the whole file would count towards its memory
+ * on top of the store: at the peak of every load, and for as long as the
+ * store lives when it borrows its text (mapText). Yet all that is ever read
+ * back from the file is the text of a few thousand distinct strings.
+ *
+ * A ReadBehind follows one thread's pass over part of a mapping and
+ * releases each window of it the pass is done with, using
+ * madvise(MADV_DONTNEED) (nothing happens on Windows). The file stays
+ * mapped and in the page cache, so borrowed text remains valid: reading it
+ * faults its page back in, and only pages holding text that is read again
+ * come back.
+ *
+ * Only ever give it a read-only file mapping; released pages of ordinary
+ * memory would read back as zeros.
+ */
+class ReadBehind {
+public:
+  // released at a time
+  static constexpr size_t WINDOW_BYTES = 4 << 20;
+
+  // the pass reads mapping[begin, end); an empty `mapping` releases nothing
+  ReadBehind(std::string_view mapping, size_t begin, size_t end);
+  ReadBehind(const ReadBehind &) = delete;
+  ReadBehind &operator=(const ReadBehind &) = delete;
+  // releases whatever of the part is left
+  ~ReadBehind();
+
+  // the pass has read up to mapping[pos]
+  void reached(size_t pos) {
+    if (pos >= next)
+      release(pos);
+  }
+  // the same for a field being read; text outside the mapping (a field the
+  // parser had to unescape) is ignored
+  void reached(const char *text) {
+    auto pos = reinterpret_cast<uintptr_t>(text) -
+               reinterpret_cast<uintptr_t>(mapping.data());
+    if (pos < end)
+      reached(pos);
+  }
+
+private:
+  void release(size_t pos);
+
+  std::string_view mapping;
+  // page aligned, except for the start of the part
+  size_t released;
+  size_t next;
+  size_t end;
+};
@@ -0,0 +1,235 @@
+#include "row_index.hpp"
+#include "binary_io.hpp"
+#include "csv.hpp"
+#include "timestamp.hpp"
+#include <algorithm>
+#include <filesystem>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static const char MAGIC[4] = {'W', 'Q', 'I', '\0'};
+// bump whenever the column layout below changes
+static const uint32_t INDEX_VERSION = 1;
+
+struct RowIndexHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t sourceSize;
+  int64_t sourceTime;
+  uint64_t sourceSample;
+  uint64_t payloadSize;
+  uint64_t payloadChecksum;
+};
+
+int32_t RowIndex::monthOf(string_view dateTime) {
+  CivilTime time;
+  if (!parseCivilTime(dateTime, time))
+    return NO_MONTH;
+  return time.year * 12 + (int32_t)time.month - 1;
+}
+
+int32_t RowIndex::monthOf(int64_t time) {
+  int64_t days = time / 86400000 - (time % 86400000 < 0);
+  int year;
+  unsigned month, day;
+  civilFromDays(days, year, month, day);
+  return year * 12 + (int32_t)month - 1;
+}
+
+void RowIndex::add(string_view point, int32_t month, uint64_t begin,
+                   uint64_t end) {
+  uint32_t p = points.intern(point);
+  if (p == open.size())
+    open.emplace_back();
+
+  // a point's rows mostly come in date order, so its current month is
+  // usually the one looked at last
+  auto &months = open[p];
+  auto last = months.rbegin();
+  while (last != months.rend() && last->first != month)
+    ++last;
+  if (last != months.rend() && begin <= rangeEnd[last->second] + RANGE_GAP) {
+    rangeEnd[last->second] = end;
+    return;
+  }
+
+  if (last != months.rend())
+    last->second = rangeBegin.size();
+  else
+    months.push_back({month, (uint32_t)rangeBegin.size()});
+  rangePoint.push_back(p);
+  rangeMonth.push_back(month);
+  rangeBegin.push_back(begin);
+  rangeEnd.push_back(end);
+}
+
+void RowIndex::merge(const RowIndex &other) {
+  // the ranges of each key are in file order, so adding them in turn
+  // joins the first one onto our last if they are close
+  for (size_t i = 0; i < other.size(); i++)
+    add(other.points.str(other.rangePoint[i]), other.rangeMonth[i],
+        other.rangeBegin[i], other.rangeEnd[i]);
+}
+
+void RowIndex::finalize() {
+  // the ranges of a key were added in file order, so sorting by key and
+  // then position keeps them that way
+  vector<pair<uint64_t, uint32_t>> order(size());
+  for (uint32_t i = 0; i < order.size(); i++)
+    order[i] = {(uint64_t)rangePoint[i] << 32 |
+                    ((uint32_t)rangeMonth[i] ^ 0x80000000u),
+                i};
+  sort(order.begin(), order.end());
+
+  auto permute = [&](auto &column) {
+    auto sorted = column;
+    for (size_t i = 0; i < order.size(); i++)
+      sorted[i] = column[order[i].second];
+    column = std::move(sorted);
+  };
+  permute(rangePoint);
+  permute(rangeMonth);
+  permute(rangeBegin);
+  permute(rangeEnd);
+  open.clear();
+}
+
+vector<ByteRange> RowIndex::find(string_view point, optional<int32_t> first,
+                                 optional<int32_t> last) const {
+  vector<ByteRange> ranges;
+  int p = points.find(point);
+  if (p < 0)
+    return ranges;
+
+  auto begin = lower_bound(rangePoint.begin(), rangePoint.end(), (uint32_t)p);
+  auto end = upper_bound(begin, rangePoint.end(), (uint32_t)p);
+  for (size_t i = begin - rangePoint.begin(); i < size_t(end - rangePoint.begin());
+       i++) {
+    int32_t month = rangeMonth[i];
+    // rows without a fixed layout time may still be in any month
+    if (month == NO_MONTH || ((!first || month >= *first) &&
+                              (!last || month <= *last)))
+      ranges.push_back({rangeBegin[i], rangeEnd[i]});
+  }
+
+  // back in file order, with ranges that touch joined up
+  sort(ranges.begin(), ranges.end(),
+       [](ByteRange a, ByteRange b) { return a.begin < b.begin; });
+  vector<ByteRange> joined;
+  for (auto range : ranges) {
+    if (!joined.empty() && range.begin <= joined.back().end + RANGE_GAP)
+      joined.back().end = max(joined.back().end, range.end);
+    else
+      joined.push_back(range);
+  }
+  return joined;
+}
+
+string rowIndexPath(const string &source) { return source + ".idx"; }
+
+bool saveRowIndex(const RowIndex &index, const string &source) {
+  try {
+    ColumnWriter writer;
+
+    vector<uint64_t> textOffsets{0};
+    vector<char> text;
+    for (uint32_t id = 0; id < index.points.size(); id++) {
+      auto str = index.points.str(id);
+      text.insert(text.end(), str.begin(), str.end());
+      textOffsets.push_back(text.size());
+    }
+    writer.column(textOffsets);
+    writer.column(text);
+
+    writer.column(index.rangePoint);
+    writer.column(index.rangeMonth);
+    writer.column(index.rangeBegin);
+    writer.column(index.rangeEnd);
+
+    RowIndexHeader header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = INDEX_VERSION;
+    header.sourceSize = fs::file_size(source);
+    header.sourceTime = modifiedTime(source);
+    header.sourceSample = sampleFile(source);
+    header.payloadSize = writer.payload.size();
+    header.payloadChecksum =
+        hashBytes(writer.payload.data(), writer.payload.size());
+
+    writeAtomically(rowIndexPath(source), &header, sizeof(header),
+                    writer.payload);
+    return true;
+  } catch (const exception &) {
+    return false;
+  }
+}
+
+bool loadRowIndex(const string &source, RowIndex &index) {
+  try {
+    string path = rowIndexPath(source);
+    if (!fs::exists(path) || fs::file_size(path) < sizeof(RowIndexHeader))
+      return false;
+
+    error_code error;
+    mio::mmap_source file = mio::make_mmap_source(path, error);
+    if (error)
+      return false;
+
+    RowIndexHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != INDEX_VERSION ||
+        header.payloadSize != file.size() - sizeof(header))
+      return false;
+
+    if (header.sourceSize != fs::file_size(source) ||
+        header.sourceTime != modifiedTime(source) ||
+        header.sourceSample != sampleFile(source))
+      return false;
+
+    const char *payload = file.data() + sizeof(header);
+    if (header.payloadChecksum != hashBytes(payload, header.payloadSize))
+      return false;
+
+    ColumnReader reader(payload, header.payloadSize);
+    RowIndex loaded;
+
+    vector<uint64_t> textOffsets;
+    vector<char> text;
+    reader.column(textOffsets);
+    reader.column(text);
+    for (size_t id = 0; id + 1 < textOffsets.size(); id++) {
+      if (textOffsets[id] > textOffsets[id + 1] ||
+          textOffsets[id + 1] > text.size())
+        return false;
+      string_view str(text.data() + textOffsets[id],
+                      textOffsets[id + 1] - textOffsets[id]);
+      if (loaded.points.intern(str) != id)
+        return false;
+    }
+
+    reader.column(loaded.rangePoint);
+    reader.column(loaded.rangeMonth);
+    reader.column(loaded.rangeBegin);
+    reader.column(loaded.rangeEnd);
+
+    size_t ranges = loaded.rangePoint.size();
+    if (loaded.rangeMonth.size() != ranges ||
+        loaded.rangeBegin.size() != ranges || loaded.rangeEnd.size() != ranges)
+      return false;
+    for (size_t i = 0; i < ranges; i++) {
+      // find() relies on the order finalize() left them in
+      if (loaded.rangePoint[i] >= loaded.points.size() ||
+          (i > 0 && loaded.rangePoint[i] < loaded.rangePoint[i - 1]) ||
+          loaded.rangeBegin[i] > loaded.rangeEnd[i] ||
+          loaded.rangeEnd[i] > header.sourceSize)
+        return false;
+    }
+
+    index = std::move(loaded);
+    return true;
+  } catch (const exception &) {
+    return false;
+  }
+}
@@ -0,0 +1,80 @@
+// Sidecar index (.idx) of where each sampling point's rows sit in a csv
+
+#pragma once
+
+#include "string_pool.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/*
+ * For every (sampling point notation, month of sampleDateTime) the index
+ * holds the byte ranges of the csv that contain its rows, so one site's
+ * history can be read without parsing the rest of the file (see
+ * loadCsvRanges). Rows of the same key that are close together share one
+ * range; the ranges may take in other rows, which the loader's LoadSpec
+ * filters out again.
+ *
+ * The file is written next to the csv like a snapshot. Its header records
+ * the csv's size, modification time and a hash of its first and last
+ * blocks; reading the whole csv to check it would cost as much as the
+ * index saves.
+ */
+struct ByteRange {
+  uint64_t begin, end;
+};
+
+class RowIndex {
+public:
+  // month of rows whose sampleDateTime is not YYYY-MM-DDTHH:MM:SS
+  static constexpr int32_t NO_MONTH = INT32_MIN;
+  // rows of a key at most this far apart go in one range
+  static constexpr uint64_t RANGE_GAP = 16 * 1024;
+
+  // months are counted as year * 12 + month - 1
+  static int32_t monthOf(std::string_view dateTime);
+  // the month a sampleTime (ms since the epoch) falls in, read as UTC
+  static int32_t monthOf(int64_t time);
+
+  // records a row; rows must be added in file order per key
+  void add(std::string_view point, int32_t month, uint64_t begin,
+           uint64_t end);
+  // appends another index built over a later part of the file
+  void merge(const RowIndex &other);
+  // sorts the ranges by key, after which find() may be used
+  void finalize();
+
+  // Ranges holding the rows of `point` in months [first, last], in file
+  // order, plus its rows of NO_MONTH. Without bounds every month is taken.
+  std::vector<ByteRange> find(std::string_view point,
+                              std::optional<int32_t> first = std::nullopt,
+                              std::optional<int32_t> last = std::nullopt) const;
+
+  size_t size() const { return rangeBegin.size(); }
+
+private:
+  friend bool saveRowIndex(const RowIndex &, const std::string &);
+  friend bool loadRowIndex(const std::string &, RowIndex &);
+
+  StringPool points;
+  // one range per entry, sorted by (point, month, begin) once finalized
+  std::vector<uint32_t> rangePoint;
+  std::vector<int32_t> rangeMonth;
+  std::vector<uint64_t> rangeBegin;
+  std::vector<uint64_t> rangeEnd;
+  // while building: for each point, the last range of each of its months
+  std::vector<std::vector<std::pair<int32_t, uint32_t>>> open;
+};
+
+// where the index of `source` lives
+std::string rowIndexPath(const std::string &source);
+
+// Returns false if the index could not be written.
+bool saveRowIndex(const RowIndex &index, const std::string &source);
+
+// Fills `index` from the index of `source` if there is one for the file as
+// it is now; returns false otherwise, leaving `index` untouched.
+bool loadRowIndex(const std::string &source, RowIndex &index);
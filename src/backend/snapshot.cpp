@@ -0,0 +1,232 @@
+#include "snapshot.hpp"
+#include "binary_io.hpp"
+#include "csv.hpp"
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static const char MAGIC[4] = {'W', 'Q', 'S', '\0'};
+// bump whenever the column layout below changes
+static const uint32_t SNAPSHOT_VERSION = 4;
+
+// 8 bytes to a field, so the columns after it stay aligned
+struct SnapshotHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t sourceSize;
+  int64_t sourceTime;
+  uint64_t sourceSample;
+  uint64_t payloadSize;
+  uint64_t payloadChecksum;
+};
+
+template <typename T>
+static void borrow(ColumnReader &reader, ColumnData<T> &column,
+                   const shared_ptr<const void> &file) {
+  size_t count;
+  const T *values = reader.view<T>(count);
+  column.borrow(values, count, file);
+}
+
+// every value is an index into a table of `count` entries
+static bool isIds(const ColumnData<uint32_t> &ids, size_t count) {
+  for (uint32_t id : ids) {
+    if (id >= count)
+      return false;
+  }
+  return true;
+}
+
+// `first` splits [0, count) into `ranges` ranges in order
+static bool isRanges(const ColumnData<uint32_t> &first, size_t ranges,
+                     size_t count) {
+  if (first.size() != ranges + 1 || first[0] != 0 || first.back() != count)
+    return false;
+  for (size_t i = 0; i + 1 < first.size(); i++) {
+    if (first[i] > first[i + 1])
+      return false;
+  }
+  return true;
+}
+
+string snapshotPath(const string &source) { return source + ".wqs"; }
+
+bool saveSnapshot(const ColumnStore &store, const string &source) {
+  try {
+    ColumnWriter writer;
+
+    vector<uint64_t> textOffsets{0};
+    vector<char> text;
+    for (uint32_t id = 0; id < store.strings.size(); id++) {
+      auto str = store.strings.str(id);
+      text.insert(text.end(), str.begin(), str.end());
+      textOffsets.push_back(text.size());
+    }
+    writer.column(textOffsets);
+    writer.column(text);
+
+    writer.column(store.pointNotation);
+    writer.column(store.pointLabel);
+    writer.column(store.pointNorthing);
+    writer.column(store.pointEasting);
+    writer.column(store.pointFirstSample);
+
+    writer.column(store.samplePoint);
+    writer.column(store.sampleIsCompliance);
+    writer.column(store.samplePurpose);
+    writer.column(store.sampleDateTime);
+    writer.column(store.sampleTime);
+    writer.column(store.sampleMaterialType);
+    writer.column(store.sampleFirstRow);
+
+    writer.column(store.determinandLabel);
+    writer.column(store.determinandDefinition);
+    writer.column(store.determinandNotation);
+    writer.column(store.determinandUnitLabel);
+
+    writer.column(store.rowPoint);
+    writer.column(store.rowSample);
+    writer.column(store.rowDeterminand);
+    writer.column(store.rowResult);
+    writer.column(vector<uint64_t>{store.duplicateRows});
+
+    SnapshotHeader header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.sourceSize = fs::file_size(source);
+    header.sourceTime = modifiedTime(source);
+    header.sourceSample = sampleFile(source);
+    header.payloadSize = writer.payload.size();
+    header.payloadChecksum =
+        hashBytes(writer.payload.data(), writer.payload.size());
+
+    writeAtomically(snapshotPath(source), &header, sizeof(header),
+                    writer.payload);
+    return true;
+  } catch (const exception &) {
+    return false;
+  }
+}
+
+bool loadSnapshot(const string &source, ColumnStore &store) {
+  try {
+    string path = snapshotPath(source);
+    if (!fs::exists(path) || fs::file_size(path) < sizeof(SnapshotHeader))
+      return false;
+
+    error_code error;
+    // shared with every column and string borrowed from it
+    auto file = make_shared<const mio::mmap_source>(
+        mio::make_mmap_source(path, error));
+    if (error)
+      return false;
+
+    SnapshotHeader header;
+    memcpy(&header, file->data(), sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != SNAPSHOT_VERSION ||
+        header.payloadSize != file->size() - sizeof(header))
+      return false;
+
+    if (header.sourceSize != fs::file_size(source) ||
+        header.sourceTime != modifiedTime(source) ||
+        header.sourceSample != sampleFile(source))
+      return false;
+
+    // Nothing is copied. The checksum catches a damaged file, the checks
+    // below one written by a build with a different layout under the same
+    // version; either way every id then points into its table.
+    const char *payload = file->data() + sizeof(header);
+    if (header.payloadChecksum != hashBytes(payload, header.payloadSize))
+      return false;
+    ColumnReader reader(payload, header.payloadSize);
+    ColumnStore loaded;
+
+    size_t offsets, bytes;
+    const uint64_t *textOffsets = reader.view<uint64_t>(offsets);
+    const char *text = reader.view<char>(bytes);
+    loaded.strings.keepAlive(file);
+    for (size_t id = 0; id + 1 < offsets; id++) {
+      if (textOffsets[id] > textOffsets[id + 1] || textOffsets[id + 1] > bytes)
+        return false;
+      string_view str(text + textOffsets[id],
+                      textOffsets[id + 1] - textOffsets[id]);
+      // ids must come back exactly as they were written
+      if (loaded.strings.intern(str, true) != id)
+        return false;
+    }
+
+    borrow(reader, loaded.pointNotation, file);
+    borrow(reader, loaded.pointLabel, file);
+    borrow(reader, loaded.pointNorthing, file);
+    borrow(reader, loaded.pointEasting, file);
+    borrow(reader, loaded.pointFirstSample, file);
+
+    borrow(reader, loaded.samplePoint, file);
+    borrow(reader, loaded.sampleIsCompliance, file);
+    borrow(reader, loaded.samplePurpose, file);
+    borrow(reader, loaded.sampleDateTime, file);
+    borrow(reader, loaded.sampleTime, file);
+    borrow(reader, loaded.sampleMaterialType, file);
+    borrow(reader, loaded.sampleFirstRow, file);
+
+    borrow(reader, loaded.determinandLabel, file);
+    borrow(reader, loaded.determinandDefinition, file);
+    borrow(reader, loaded.determinandNotation, file);
+    borrow(reader, loaded.determinandUnitLabel, file);
+
+    borrow(reader, loaded.rowPoint, file);
+    borrow(reader, loaded.rowSample, file);
+    borrow(reader, loaded.rowDeterminand, file);
+    borrow(reader, loaded.rowResult, file);
+    size_t counts;
+    const uint64_t *duplicateRows = reader.view<uint64_t>(counts);
+    if (counts != 1)
+      return false;
+    loaded.duplicateRows = duplicateRows[0];
+
+    size_t points = loaded.pointCount(), samples = loaded.sampleCount();
+    size_t determinands = loaded.determinandCount(), rows = loaded.rowCount();
+    if (loaded.pointLabel.size() != points ||
+        loaded.pointNorthing.size() != points ||
+        loaded.pointEasting.size() != points ||
+        loaded.sampleIsCompliance.size() != samples ||
+        loaded.samplePurpose.size() != samples ||
+        loaded.sampleDateTime.size() != samples ||
+        loaded.sampleTime.size() != samples ||
+        loaded.sampleMaterialType.size() != samples ||
+        loaded.determinandLabel.size() != determinands ||
+        loaded.determinandDefinition.size() != determinands ||
+        loaded.determinandUnitLabel.size() != determinands ||
+        loaded.rowPoint.size() != rows ||
+        loaded.rowDeterminand.size() != rows ||
+        loaded.rowResult.size() != rows ||
+        !isRanges(loaded.pointFirstSample, points, samples) ||
+        !isRanges(loaded.sampleFirstRow, samples, rows))
+      return false;
+
+    size_t texts = loaded.strings.size();
+    for (auto *ids : {&loaded.pointNotation, &loaded.pointLabel,
+                      &loaded.samplePurpose, &loaded.sampleDateTime,
+                      &loaded.sampleMaterialType, &loaded.determinandLabel,
+                      &loaded.determinandDefinition,
+                      &loaded.determinandNotation,
+                      &loaded.determinandUnitLabel}) {
+      if (!isIds(*ids, texts))
+        return false;
+    }
+    if (!isIds(loaded.samplePoint, points) ||
+        !isIds(loaded.rowPoint, points) || !isIds(loaded.rowSample, samples) ||
+        !isIds(loaded.rowDeterminand, determinands))
+      return false;
+
+    loaded.rebuildIndexes();
+    store = std::move(loaded);
+    return true;
+  } catch (const exception &) {
+    return false;
+  }
+}
@@ -0,0 +1,31 @@
+// Binary snapshots (.wqs) of a loaded ColumnStore
+
+#pragma once
+
+#include "column_store.hpp"
+#include <string>
+
+/*
+ * A snapshot is the finalized ColumnStore written out column by column,
+ * next to the csv it was built from. The header records the snapshot
+ * version, a checksum of the payload, and the size, modification time and
+ * sampleFile() hash of the source csv, so telling whether it is current
+ * reads 128KB of the csv.
+ *
+ * Reopening maps the file and the store's columns and text borrow from the
+ * mapping (see ColumnData), so nothing is parsed or copied. The payload is
+ * checksummed and every id checked against its table once; only the point
+ * and determinand indexes are rebuilt. Every column starts 8-byte aligned.
+ */
+
+// where the snapshot of `source` lives
+std::string snapshotPath(const std::string &source);
+
+// Writes the snapshot of `store`, which was loaded from `source`. Returns
+// false if it could not be written (e.g. a read-only directory).
+bool saveSnapshot(const ColumnStore &store, const std::string &source);
+
+// Fills `store` from the snapshot of `source` if there is one for the file
+// as it is now. Returns false if it is missing, stale or damaged, in which
+// case `store` is left untouched.
+bool loadSnapshot(const std::string &source, ColumnStore &store);
@@ -0,0 +1,90 @@
+#include "string_pool.hpp"
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+StringPool::StringPool(const StringPool &other)
+    : hashes(other.hashes), borrowed(other.borrowed), qstrings(other.qstrings),
+      sources(other.sources), slots(other.slots) {
+  strings.reserve(other.strings.size());
+  for (uint32_t id = 0; id < other.strings.size(); id++) {
+    auto text = other.strings[id];
+    strings.push_back(borrowed[id] ? text : arena.copy(text));
+  }
+}
+
+StringPool &StringPool::operator=(const StringPool &other) {
+  if (this != &other)
+    *this = StringPool(other);
+  return *this;
+}
+
+size_t StringPool::slotOf(string_view text, size_t hash) const {
+  size_t mask = slots.size() - 1;
+  size_t slot = hash & mask;
+  while (slots[slot]) {
+    uint32_t id = slots[slot] - 1;
+    if (hashes[id] == hash && strings[id] == text)
+      break;
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+void StringPool::rehash(size_t capacity) {
+  slots.assign(capacity, 0);
+  size_t mask = capacity - 1;
+  for (uint32_t id = 0; id < strings.size(); id++) {
+    size_t slot = hashes[id] & mask;
+    while (slots[slot])
+      slot = (slot + 1) & mask;
+    slots[slot] = id + 1;
+  }
+}
+
+uint32_t StringPool::intern(string_view text, bool borrow) {
+  // keep the table at most half full
+  if ((strings.size() + 1) * 2 > slots.size())
+    rehash(max<size_t>(64, slots.size() * 2));
+
+  size_t hash = std::hash<string_view>()(text);
+  size_t slot = slotOf(text, hash);
+  if (slots[slot])
+    return slots[slot] - 1;
+
+  uint32_t id = strings.size();
+  strings.push_back(borrow ? text : arena.copy(text));
+  hashes.push_back(hash);
+  borrowed.push_back(borrow);
+  qstrings.emplace_back();
+  slots[slot] = id + 1;
+  return id;
+}
+
+int StringPool::find(string_view text) const {
+  if (slots.empty())
+    return -1;
+
+  size_t slot = slotOf(text, std::hash<string_view>()(text));
+  if (!slots[slot])
+    return -1;
+  return slots[slot] - 1;
+}
+
+void StringPool::keepAlive(shared_ptr<const void> source) {
+  if (std::find(sources.begin(), sources.end(), source) == sources.end())
+    sources.push_back(std::move(source));
+}
+
+void StringPool::keepAlive(const StringPool &other) {
+  for (const auto &source : other.sources)
+    keepAlive(source);
+}
+
+const QString &StringPool::qstr(uint32_t id) const {
+  QString &text = qstrings[id];
+  if (text.isNull() && !strings[id].empty())
+    text = QString::fromUtf8(strings[id].data(), strings[id].size());
+  return text;
+}
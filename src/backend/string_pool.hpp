@@ -0,0 +1,62 @@
+// Dataset-wide dictionary of the text values found in a csv
+
+#pragma once
+
+#include "arena.hpp"
+#include <QString>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/*
+ * Each distinct string gets a compact integer id. Labels, units, purposes
+ * etc. only take a few hundred distinct values across a whole file, so the
+ * column store keeps the ids and every page looks the text (or its cached
+ * QString) up here instead of converting it again for every row.
+ *
+ * The text lives in an Arena and the index is an open addressing table, so
+ * interning a new value does not allocate per string. Text can also be
+ * borrowed instead of copied, from a source (the mapped csv) that the pool
+ * keeps alive.
+ *
+ * QStrings are only built the first time qstr() asks for one, so text that
+ * is never displayed is never converted.
+ */
+class StringPool {
+public:
+  StringPool() = default;
+  StringPool(const StringPool &other);
+  StringPool &operator=(const StringPool &other);
+  StringPool(StringPool &&) = default;
+  StringPool &operator=(StringPool &&) = default;
+
+  // `borrowed` text is not copied, it must live in a source handed to
+  // keepAlive() (or to the pool it came from)
+  uint32_t intern(std::string_view text, bool borrowed = false);
+  void keepAlive(std::shared_ptr<const void> source);
+  // keeps everything `other` borrows from alive as well
+  void keepAlive(const StringPool &other);
+  // id of an already interned string, -1 if it has never been seen
+  int find(std::string_view text) const;
+
+  std::string_view str(uint32_t id) const { return strings[id]; }
+  // converted on first use; not thread safe, call from the GUI thread
+  const QString &qstr(uint32_t id) const;
+  bool isBorrowed(uint32_t id) const { return borrowed[id]; }
+  size_t size() const { return strings.size(); }
+
+private:
+  size_t slotOf(std::string_view text, size_t hash) const;
+  void rehash(size_t capacity);
+
+  Arena arena;
+  std::vector<std::string_view> strings;
+  std::vector<size_t> hashes;
+  std::vector<bool> borrowed;
+  // null until qstr() converts the string
+  mutable std::vector<QString> qstrings;
+  std::vector<std::shared_ptr<const void>> sources;
+  // id + 1 of the string in each slot, 0 for an empty slot
+  std::vector<uint32_t> slots;
+};
@@ -0,0 +1,120 @@
+#include "timestamp.hpp"
+#include <QDateTime>
+#include <QString>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+static const int64_t MSECS_PER_HOUR = 3600 * 1000;
+
+// '0' where the layout has a digit, the separator byte elsewhere
+static const char LAYOUT[] = "0000-00-00T00:00:00";
+static const size_t LAYOUT_SIZE = sizeof(LAYOUT) - 1;
+// largest allowed value of text[i] - LAYOUT[i]
+static const uint8_t LIMIT[LAYOUT_SIZE] = {9, 9, 9, 9, 0, 9, 9, 0, 9, 9,
+                                           0, 9, 9, 0, 9, 9, 0, 9, 9};
+
+// Writes text[i] - LAYOUT[i] for every byte (the digit values, 0 for the
+// separators) and checks them all against LIMIT without branching per byte.
+static bool decodeLayout(const char *text, uint8_t digits[LAYOUT_SIZE]) {
+  unsigned bad = 0;
+  size_t i = 0;
+#ifdef __SSE2__
+  __m128i value =
+      _mm_sub_epi8(_mm_loadu_si128((const __m128i *)text),
+                   _mm_loadu_si128((const __m128i *)LAYOUT));
+  __m128i over =
+      _mm_subs_epu8(value, _mm_loadu_si128((const __m128i *)LIMIT));
+  _mm_storeu_si128((__m128i *)digits, value);
+  bad = _mm_movemask_epi8(_mm_cmpeq_epi8(over, _mm_setzero_si128())) ^ 0xFFFF;
+  i = 16;
+#endif
+  for (; i < LAYOUT_SIZE; i++) {
+    digits[i] = (uint8_t)(text[i] - LAYOUT[i]);
+    bad |= digits[i] > LIMIT[i];
+  }
+  return bad == 0;
+}
+
+static unsigned daysInMonth(int year, unsigned month) {
+  static const uint8_t DAYS[] = {31, 28, 31, 30, 31, 30,
+                                 31, 31, 30, 31, 30, 31};
+  bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+  return DAYS[month - 1] + (month == 2 && leap);
+}
+
+bool parseCivilTime(string_view text, CivilTime &time) {
+  if (text.size() != LAYOUT_SIZE)
+    return false;
+
+  uint8_t d[LAYOUT_SIZE];
+  if (!decodeLayout(text.data(), d))
+    return false;
+
+  time.year = d[0] * 1000 + d[1] * 100 + d[2] * 10 + d[3];
+  time.month = d[5] * 10 + d[6];
+  time.day = d[8] * 10 + d[9];
+  time.hour = d[11] * 10 + d[12];
+  time.minute = d[14] * 10 + d[15];
+  time.second = d[17] * 10 + d[18];
+
+  return time.month >= 1 && time.month <= 12 && time.day >= 1 &&
+         time.day <= daysInMonth(time.year, time.month) && time.hour < 24 &&
+         time.minute < 60 && time.second < 60;
+}
+
+// Howard Hinnant's days_from_civil
+int64_t daysFromCivil(int year, unsigned month, unsigned day) {
+  int64_t y = (int64_t)year - (month <= 2);
+  int64_t era = (y >= 0 ? y : y - 399) / 400;
+  unsigned yoe = (unsigned)(y - era * 400);
+  unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int64_t)doe - 719468;
+}
+
+// Howard Hinnant's civil_from_days
+void civilFromDays(int64_t days, int &year, unsigned &month, unsigned &day) {
+  days += 719468;
+  int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  unsigned doe = (unsigned)(days - era * 146097);
+  unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  unsigned mp = (5 * doy + 2) / 153;
+  day = doy - (153 * mp + 2) / 5 + 1;
+  month = mp < 10 ? mp + 3 : mp - 9;
+  year = (int)(yoe + era * 400 + (month <= 2));
+}
+
+int64_t civilToMSecs(const CivilTime &time) {
+  int64_t seconds = daysFromCivil(time.year, time.month, time.day) * 86400 +
+                    time.hour * 3600 + time.minute * 60 + time.second;
+  return seconds * 1000;
+}
+
+optional<int64_t> TimestampParser::parse(string_view text) {
+  CivilTime time;
+  if (!parseCivilTime(text, time)) {
+    QDateTime slow = QDateTime::fromString(
+        QString::fromUtf8(text.data(), text.size()), Qt::ISODateWithMs);
+    if (!slow.isValid())
+      return nullopt;
+    return slow.toMSecsSinceEpoch();
+  }
+
+  int64_t civil = civilToMSecs(time);
+  int64_t hour = civil / MSECS_PER_HOUR - (civil % MSECS_PER_HOUR < 0);
+
+  auto offset = hourOffsets.find(hour);
+  if (offset == hourOffsets.end()) {
+    QDateTime local(QDate(time.year, time.month, time.day),
+                    QTime(time.hour, 0));
+    offset = hourOffsets
+                 .emplace(hour, local.toMSecsSinceEpoch() - hour * MSECS_PER_HOUR)
+                 .first;
+  }
+  return civil + offset->second;
+}
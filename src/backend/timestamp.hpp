@@ -0,0 +1,46 @@
+// Fast parsing of the sampleDateTime column
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
+/*
+ * EA exports always write sample times as "YYYY-MM-DDTHH:MM:SS" with no
+ * zone. parseCivilTime() validates and decodes exactly that layout with
+ * plain digit arithmetic, so the common case never builds a QString.
+ */
+struct CivilTime {
+  int year;
+  unsigned month, day;
+  unsigned hour, minute, second;
+};
+
+// false if `text` is not exactly YYYY-MM-DDTHH:MM:SS with in-range fields
+bool parseCivilTime(std::string_view text, CivilTime &time);
+
+// days since 1970-01-01 in the proleptic Gregorian calendar
+int64_t daysFromCivil(int year, unsigned month, unsigned day);
+// the inverse of daysFromCivil
+void civilFromDays(int64_t days, int &year, unsigned &month, unsigned &day);
+
+// the civil time read as UTC, in ms since the epoch
+int64_t civilToMSecs(const CivilTime &time);
+
+/*
+ * Turns sampleDateTime text into ms since the epoch with the same meaning
+ * as QDateTime::fromString(text, Qt::ISODateWithMs), i.e. zoneless times
+ * are local time. The local UTC offset is looked up through QDateTime once
+ * per civil hour and cached; anything that does not match the fixed layout
+ * goes through QDateTime itself.
+ */
+class TimestampParser {
+public:
+  std::optional<int64_t> parse(std::string_view text);
+
+private:
+  // civil hour (hours since the epoch, read as UTC) -> local offset in ms
+  std::unordered_map<int64_t, int64_t> hourOffsets;
+};
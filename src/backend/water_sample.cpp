@@ -1,47 +1,113 @@
 #include "water_sample.hpp"
-#include <algorithm>
+#include "column_store.hpp"
 #include <vector>
 
 using namespace std;
 
-Determinand::Determinand(string label, string definition, string notation,
-                         string unit_label, double result)
-    : label(label), definition(definition), notation(notation),
-      unit_label(unit_label), result(result) {}
+uint32_t Determinand::getId() const { return store->rowDeterminand[row]; }
 
-Sample::Sample(bool isComplianceSample, string purpose, string dateTime,
-               string sampledMaterialType)
-    : isComplianceSample(isComplianceSample), purpose(purpose),
-      dateTime(dateTime), sampledMaterialType(sampledMaterialType) {
-  determinands = new vector<Determinand *>();
+string_view Determinand::getLabel() const {
+  return store->strings.str(store->determinandLabel[getId()]);
 }
 
-SamplingPoint::SamplingPoint(string notation, int northing, int easting,
-                             string label)
-    : notation(notation), northing(northing), easting(easting), label(label) {
-  samples = new vector<Sample *>();
+string_view Determinand::getDefinition() const {
+  return store->strings.str(store->determinandDefinition[getId()]);
 }
 
-Sample *SamplingPoint::getSampleFromDateTime(const string &dateTime) {
-  if (!hasSamples())
-    return nullptr;
+string_view Determinand::getNotation() const {
+  return store->strings.str(store->determinandNotation[getId()]);
+}
+
+string_view Determinand::getUnitLabel() const {
+  return store->strings.str(store->determinandUnitLabel[getId()]);
+}
+
+double Determinand::getResult() const { return store->rowResult[row]; }
+
+const QString &Determinand::getQLabel() const {
+  return store->strings.qstr(store->determinandLabel[getId()]);
+}
+
+const QString &Determinand::getQDefinition() const {
+  return store->strings.qstr(store->determinandDefinition[getId()]);
+}
+
+const QString &Determinand::getQUnitLabel() const {
+  return store->strings.qstr(store->determinandUnitLabel[getId()]);
+}
+
+bool Sample::getIsComplianceSample() const {
+  return store->sampleIsCompliance[id];
+}
+
+string_view Sample::getPurpose() const {
+  return store->strings.str(store->samplePurpose[id]);
+}
+
+string_view Sample::getDateTime() const {
+  return store->strings.str(store->sampleDateTime[id]);
+}
+
+string_view Sample::getSampledMaterialType() const {
+  return store->strings.str(store->sampleMaterialType[id]);
+}
+
+const QString &Sample::getQDateTime() const {
+  return store->strings.qstr(store->sampleDateTime[id]);
+}
 
-  auto sample =
-      find_if(samples->begin(), samples->end(),
-              [&dateTime](Sample *s) { return s->getDateTime() == dateTime; });
+int64_t Sample::getTimestamp() const { return store->sampleTime[id]; }
+
+bool Sample::hasTimestamp() const {
+  return store->sampleTime[id] != ColumnStore::NO_TIME;
+}
 
-  if (sample != samples->end())
-    return *sample;
-  return nullptr;
+DeterminandRange Sample::getDeterminands() const {
+  return DeterminandRange(store, store->sampleFirstRow[id],
+                          store->sampleFirstRow[id + 1]);
 }
 
-double Sample::getResultFromLabel(std::string label) {
-  auto det =
-      find_if(determinands->begin(), determinands->end(),
-              [&label](Determinand *d) { return d->getLabel() == label; });
+double Sample::getResultFromLabel(string_view label) const {
+  int text = store->strings.find(label);
+  if (text < 0)
+    return -1;
 
-  if (det != determinands->end()) {
-    return (*det)->getResult();
+  for (uint32_t row = store->sampleFirstRow[id];
+       row < store->sampleFirstRow[id + 1]; row++) {
+    if (store->determinandLabel[store->rowDeterminand[row]] == (uint32_t)text)
+      return store->rowResult[row];
   }
   return -1;
 }
+
+string_view SamplingPoint::getNotation() const {
+  return store->strings.str(store->pointNotation[id]);
+}
+
+const QString &SamplingPoint::getQLabel() const {
+  return store->strings.qstr(store->pointLabel[id]);
+}
+
+int SamplingPoint::getNorthing() const { return store->pointNorthing[id]; }
+
+int SamplingPoint::getEasting() const { return store->pointEasting[id]; }
+
+string_view SamplingPoint::getLabel() const {
+  return store->strings.str(store->pointLabel[id]);
+}
+
+SampleRange SamplingPoint::getSamples() const {
+  return SampleRange(store, store->pointFirstSample[id],
+                     store->pointFirstSample[id + 1]);
+}
+
+optional<Sample>
+SamplingPoint::getSampleFromDateTime(string_view dateTime) const {
+  int text = store->strings.find(dateTime);
+  if (text < 0)
+    return nullopt;
+  int sample = store->findSample(id, text);
+  if (sample < 0)
+    return nullopt;
+  return Sample(store, sample);
+}
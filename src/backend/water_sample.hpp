@@ -1,6 +1,10 @@
 #pragma once
 
+#include <QString>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 using namespace std;
@@ -39,78 +43,122 @@ using namespace std;
  *
  */
 
+class ColumnStore;
+
+// Views are cheap (store, index) handles into a ColumnStore; they stay valid
+// as long as the dataset that produced them.
+template <typename View> class ViewRange {
+public:
+  class iterator {
+  public:
+    iterator(const ColumnStore *store, uint32_t index)
+        : store(store), index(index) {}
+    View operator*() const { return View(store, index); }
+    iterator &operator++() {
+      index++;
+      return *this;
+    }
+    bool operator!=(const iterator &other) const {
+      return index != other.index;
+    }
+    bool operator==(const iterator &other) const {
+      return index == other.index;
+    }
+
+  private:
+    const ColumnStore *store;
+    uint32_t index;
+  };
+
+  ViewRange(const ColumnStore *store, uint32_t first, uint32_t last)
+      : store(store), first(first), last(last) {}
+  iterator begin() const { return iterator(store, first); }
+  iterator end() const { return iterator(store, last); }
+  size_t size() const { return last - first; }
+  bool empty() const { return first == last; }
+  View operator[](size_t i) const { return View(store, first + i); }
+
+private:
+  const ColumnStore *store;
+  uint32_t first;
+  uint32_t last;
+};
+
 class Determinand
 {
 public:
-  // default constructor for a determinand to parse the information from csv
-  // into class
-  Determinand(string label, string definition, string notation,
-              string unit_label, double result);
+  // view over a single csv row of the column store
+  Determinand(const ColumnStore *store, uint32_t row)
+      : store(store), row(row) {}
   // getter method
-  string getLabel() const { return label; }
-  string getDefinition() const { return definition; }
-  string getNotation() const { return notation; }
-  string getUnitLabel() const { return unit_label; }
-  double getResult() const { return result; }
+  std::string_view getLabel() const;
+  std::string_view getDefinition() const;
+  std::string_view getNotation() const;
+  std::string_view getUnitLabel() const;
+  double getResult() const;
+  // cached conversions, no per-row string copies
+  const QString &getQLabel() const;
+  const QString &getQDefinition() const;
+  const QString &getQUnitLabel() const;
+
+  uint32_t getRow() const { return row; }
+  uint32_t getId() const;
 
 private:
-  string label;
-  string definition;
-  string notation;
-  string unit_label;
-  double result;
+  const ColumnStore *store;
+  uint32_t row;
 };
 
+using DeterminandRange = ViewRange<Determinand>;
+
 class Sample
 {
 public:
-  // default cosntructor defining the information shared between samples
-  Sample(bool isComplianceSample, string purpose, string dateTime,
-         string sampledMaterialType);
+  Sample(const ColumnStore *store, uint32_t id) : store(store), id(id) {}
   // getter mehtods
-  bool getIsComplianceSample() const { return isComplianceSample; }
-  string getPurpose() const { return purpose; }
-  string getDateTime() const { return dateTime; }
-  string getSampledMaterialType() { return sampledMaterialType; }
+  bool getIsComplianceSample() const;
+  std::string_view getPurpose() const;
+  std::string_view getDateTime() const;
+  std::string_view getSampledMaterialType() const;
+  const QString &getQDateTime() const;
+  // sample time in ms since the epoch, parsed once at load
+  int64_t getTimestamp() const;
+  bool hasTimestamp() const;
 
-  bool hasElements() { return determinands->size() > 0;}
-  std::vector<Determinand*> *getDeterminands() { return determinands;}
-  double getResultFromLabel(std::string label);
+  bool hasElements() const { return !getDeterminands().empty(); }
+  DeterminandRange getDeterminands() const;
+  double getResultFromLabel(std::string_view label) const;
 
-  void addDeterminand(Determinand *d) { determinands->push_back(d); }
-  const std::vector<Determinand *> *getDeterminands() const { return determinands; }
+  uint32_t getId() const { return id; }
 
 private:
-  bool isComplianceSample;
-  string purpose;
-  string dateTime;
-  string sampledMaterialType;
-  vector<Determinand *> *determinands;
+  const ColumnStore *store;
+  uint32_t id;
 };
 
+using SampleRange = ViewRange<Sample>;
+
 class SamplingPoint
 {
 public:
-  SamplingPoint(string notation, int northing, int easting, string label);
+  SamplingPoint(const ColumnStore *store, uint32_t id) : store(store), id(id) {}
   // default getters to return point information
-  string getNotation() const { return notation; }
-  int getNorthing() const { return northing; }
-  int getEasting() const { return easting; }
-  string getLabel() const { return label; }
-  int getNoSamples() const { return samples->size(); }
-  bool hasSamples() const { return samples->size() > 0; }
-
-  const vector<Sample *> *getSamples() { return samples; }
+  std::string_view getNotation() const;
+  int getNorthing() const;
+  int getEasting() const;
+  std::string_view getLabel() const;
+  const QString &getQLabel() const;
+  int getNoSamples() const { return getSamples().size(); }
+  bool hasSamples() const { return !getSamples().empty(); }
 
-  Sample *getSampleFromDateTime(const string &dateTime);
-  const std::vector<Sample *> *getSamples() const { return samples; }
+  SampleRange getSamples() const;
+  std::optional<Sample> getSampleFromDateTime(std::string_view dateTime) const;
 
-  void addSample(Sample *s) { samples->push_back(s); }
+  uint32_t getId() const { return id; }
 
 private:
-  string notation;
-  int northing;
-  int easting;
-  string label;
-  vector<Sample *> *samples;
+  const ColumnStore *store;
+  uint32_t id;
 };
+
+using SamplingPointRange = ViewRange<SamplingPoint>;
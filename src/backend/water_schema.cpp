@@ -0,0 +1,23 @@
+#include "water_schema.hpp"
+#include <stdexcept>
+
+using namespace std;
+
+ColumnBinding::ColumnBinding(const vector<string> &header,
+                             const ColumnSet &wanted) {
+  string missing;
+  for (size_t c = 0; c < COLUMN_COUNT; c++) {
+    indices[c] = UNBOUND;
+    if (!wanted[c])
+      continue;
+    size_t i = 0;
+    while (i < header.size() && header[i] != COLUMN_NAMES[c])
+      i++;
+    if (i == header.size())
+      missing += (missing.empty() ? "" : ", ") + string(COLUMN_NAMES[c]);
+    indices[c] = i;
+  }
+
+  if (!missing.empty())
+    throw runtime_error("Missing columns: " + missing);
+}
@@ -0,0 +1,70 @@
+// Columns of an EA water quality export read by the loader
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * The loader refers to fields through this enum instead of by name. A
+ * ColumnBinding resolves every column against the file's header once, so
+ * reading a field in the row loop is a plain index.
+ */
+enum class Column {
+  SamplingPointNotation,
+  SamplingPointNorthing,
+  SamplingPointEasting,
+  SamplingPointLabel,
+  SamplePurpose,
+  SampledMaterialType,
+  SampleDateTime,
+  IsComplianceSample,
+  DeterminandNotation,
+  DeterminandLabel,
+  DeterminandDefinition,
+  DeterminandUnitLabel,
+  Result,
+};
+
+constexpr size_t COLUMN_COUNT = (size_t)Column::Result + 1;
+
+// header names, in Column order
+constexpr std::array<const char *, COLUMN_COUNT> COLUMN_NAMES = {
+    "sample.samplingPoint.notation",
+    "sample.samplingPoint.northing",
+    "sample.samplingPoint.easting",
+    "sample.samplingPoint.label",
+    "sample.purpose.label",
+    "sample.sampledMaterialType.label",
+    "sample.sampleDateTime",
+    "sample.isComplianceSample",
+    "determinand.notation",
+    "determinand.label",
+    "determinand.definition",
+    "determinand.unit.label",
+    "result",
+};
+
+// a set of columns, indexed by Column
+using ColumnSet = std::bitset<COLUMN_COUNT>;
+
+class ColumnBinding {
+public:
+  // index of a column that was not asked for
+  static constexpr size_t UNBOUND = SIZE_MAX;
+
+  // binds the `wanted` columns; throws std::runtime_error naming every one
+  // of them the header lacks
+  explicit ColumnBinding(const std::vector<std::string> &header,
+                         const ColumnSet &wanted = ColumnSet().set());
+
+  size_t operator[](Column column) const { return indices[(size_t)column]; }
+  bool has(Column column) const { return indices[(size_t)column] != UNBOUND; }
+
+private:
+  std::array<size_t, COLUMN_COUNT> indices;
+};
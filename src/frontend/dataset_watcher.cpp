@@ -0,0 +1,135 @@
+#include "dataset_watcher.hpp"
+#include "csv_loader.hpp"
+
+DatasetWatcher::DatasetWatcher(QObject *parent) : QObject(parent) {
+  watcher = new QFileSystemWatcher(this);
+  connect(watcher, &QFileSystemWatcher::fileChanged, this,
+          &DatasetWatcher::scan);
+  connect(watcher, &QFileSystemWatcher::directoryChanged, this,
+          &DatasetWatcher::scan);
+}
+
+DatasetWatcher::~DatasetWatcher() {
+  if (readThread)
+    readThread->wait();
+}
+
+void DatasetWatcher::watch(WaterDataset *watched, const QStringList &files,
+                           const QList<qint64> &sizes) {
+  stop();
+  dataset = watched;
+  spec = watched->getLoadSpec();
+  for (int i = 0; i < files.size(); i++) {
+    offsets[files[i]] = sizes[i];
+    auto folder = QFileInfo(files[i]).absolutePath();
+    if (!folders.contains(folder))
+      folders.append(folder);
+  }
+  watcher->addPaths(files);
+  watcher->addPaths(folders);
+  // anything written between the load and now
+  scan();
+}
+
+void DatasetWatcher::stop() {
+  if (readThread) {
+    // a read only touches the files and `tails`, the result is dropped
+    readThread->wait();
+    readThread->deleteLater();
+    readThread = nullptr;
+  }
+  generation++;
+  tails.clear();
+  if (!watcher->files().isEmpty())
+    watcher->removePaths(watcher->files());
+  if (!watcher->directories().isEmpty())
+    watcher->removePaths(watcher->directories());
+  offsets.clear();
+  folders.clear();
+  dataset = nullptr;
+  rescan = false;
+}
+
+void DatasetWatcher::scan() {
+  if (!dataset)
+    return;
+  if (readThread) {
+    rescan = true;
+    return;
+  }
+
+  // new csv files in the folders are read from the start
+  for (const auto &folder : folders) {
+    for (const auto &entry :
+         QDir(folder).entryInfoList({"*.csv"}, QDir::Files)) {
+      auto file = entry.absoluteFilePath();
+      if (!offsets.contains(file))
+        offsets[file] = 0;
+    }
+  }
+
+  tails.clear();
+  for (auto i = offsets.begin(); i != offsets.end(); ++i) {
+    QFileInfo info(i.key());
+    if (!info.exists())
+      continue;
+    // files replaced by a rename drop out of the watcher
+    if (!watcher->files().contains(i.key()))
+      watcher->addPath(i.key());
+    if ((size_t)info.size() > i.value())
+      tails.push_back({i.key(), i.value(), ColumnStore()});
+  }
+  if (tails.empty())
+    return;
+
+  readThread = QThread::create([this] {
+    for (auto &tail : tails) {
+      try {
+        tail.offset = loadCsvTail(tail.file.toStdString(), tail.offset,
+                                  tail.rows, spec);
+      } catch (const std::exception &error) {
+        // not an EA export (or unreadable); skip what is there now
+        qWarning() << "Not following" << tail.file << ":" << error.what();
+        tail.rows.clear();
+        tail.offset = QFileInfo(tail.file).size();
+      }
+    }
+  });
+  connect(readThread, &QThread::finished, this,
+          [this, started = generation] { finishRead(started); });
+  readThread->start();
+}
+
+void DatasetWatcher::finishRead(int started) {
+  // stopped (and maybe restarted) while reading
+  if (started != generation)
+    return;
+  readThread->wait();
+  readThread->deleteLater();
+  readThread = nullptr;
+
+  std::vector<SamplingPoint> changed;
+  for (auto &tail : tails) {
+    if (tail.rows.rowCount() == 0) {
+      offsets[tail.file] = tail.offset;
+      continue;
+    }
+    try {
+      auto points = dataset->append(tail.rows);
+      changed.insert(changed.end(), points.begin(), points.end());
+      offsets[tail.file] = tail.offset;
+    } catch (const std::exception &error) {
+      // a repeated row under DuplicatePolicy::Error, the dataset is unchanged
+      // and the offset stays put so the rows are read again next time
+      qWarning() << "Rows appended to" << tail.file << ":" << error.what();
+    }
+  }
+  tails.clear();
+  if (!changed.empty())
+    emit pointsChanged(changed);
+
+  if (rescan) {
+    rescan = false;
+    scan();
+  }
+}
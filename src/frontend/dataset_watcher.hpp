@@ -0,0 +1,52 @@
+#pragma once
+
+#include "dataset.hpp"
+#include <QtWidgets>
+#include <exception>
+#include <vector>
+
+// Follows the files a dataset was loaded from, and new csv files appearing in
+// their folders, and appends whatever they gain to the dataset. Only the new
+// bytes are parsed, on a worker thread; the dataset itself is only changed
+// on the GUI thread, right before pointsChanged is emitted.
+class DatasetWatcher : public QObject {
+  Q_OBJECT
+
+public:
+  DatasetWatcher(QObject *parent = nullptr);
+  ~DatasetWatcher();
+
+  // `sizes` are the file sizes the dataset was loaded at
+  void watch(WaterDataset *dataset, const QStringList &files,
+             const QList<qint64> &sizes);
+  void stop();
+
+signals:
+  // the points that gained samples or rows, in the watched dataset
+  void pointsChanged(const std::vector<SamplingPoint> &points);
+
+private:
+  struct Tail {
+    QString file;
+    size_t offset;
+    ColumnStore rows;
+  };
+
+  QFileSystemWatcher *watcher;
+  WaterDataset *dataset = nullptr;
+  // the dataset's, copied so the worker never reads the dataset
+  LoadSpec spec;
+  // where every followed file has been read up to
+  QMap<QString, size_t> offsets;
+  QStringList folders;
+
+  QThread *readThread = nullptr;
+  std::vector<Tail> tails;
+  // set when something changes while a read is running
+  bool rescan = false;
+  // bumped by stop(), so a read that was already queued is dropped
+  int generation = 0;
+
+  void scan();
+  void finishRead(int started);
+};
@@ -22,8 +22,9 @@ void EnvironmentalLitterPage::updateData(WaterDataset *newDataset) {
   if (!complianceStatus.empty())
     complianceStatus.clear();
 
-  // Re-aggregate the data with the new dataset
-  aggregateData(*newDataset);
+  // Re-aggregate the data with the new dataset, none leaves the page empty
+  if (newDataset)
+    aggregateData(*newDataset);
   calculateCompliance();
 
   // **Update UI elements**
@@ -32,7 +33,15 @@ void EnvironmentalLitterPage::updateData(WaterDataset *newDataset) {
   updateChart();             // Update chart data
 }
 
+// Called again for every partial dataset and every append, so the current
+// location and litter type are kept if the new data still has them.
 void EnvironmentalLitterPage::updateFilters() {
+  QString selectedLocation = locationFilter->currentData().toString();
+  QString selectedLitterType = litterTypeFilter->currentText();
+  // updateData() redraws the chart once both are filled
+  QSignalBlocker locationBlocker(locationFilter);
+  QSignalBlocker litterTypeBlocker(litterTypeFilter);
+
   // **Update Location Filter**
   locationFilter->clear(); // Clear existing options
   locationFilter->addItem("All Locations", "All Locations"); // Default option
@@ -41,6 +50,8 @@ void EnvironmentalLitterPage::updateFilters() {
     QString displayLocation = location;
     locationFilter->addItem(displayLocation, location);
   }
+  locationFilter->setCurrentIndex(
+      std::max(0, locationFilter->findData(selectedLocation)));
 
   // **Update Litter Type Filter**
   litterTypeFilter->clear();                     // Clear existing options
@@ -55,26 +66,25 @@ void EnvironmentalLitterPage::updateFilters() {
     qDebug() << "Warning: No data found for Litter Types. Defaulting to 'All "
                 "Litter Types'.";
   }
+  litterTypeFilter->setCurrentIndex(
+      std::max(0, litterTypeFilter->findText(selectedLitterType)));
 }
 
 void EnvironmentalLitterPage::aggregateData(WaterDataset &dataset) {
-  for (const auto &pointPair : *(dataset.getData())) {
-    SamplingPoint *samplingPoint = pointPair.second;
-    const auto *samples = samplingPoint->getSamples();
-    QString locationLabel = QString::fromStdString(samplingPoint->getLabel());
+  for (auto samplingPoint : dataset.getPoints()) {
+    QString locationLabel = samplingPoint.getQLabel();
 
-    for (Sample *sample : *samples) {
-      const auto *determinands = sample->getDeterminands();
+    for (auto sample : samplingPoint.getSamples()) {
+      auto determinands = sample.getDeterminands();
 
       if (!totalDeterminands.contains(locationLabel))
         totalDeterminands[locationLabel] = 0;
 
-      totalDeterminands[locationLabel] += determinands->size();
+      totalDeterminands[locationLabel] += determinands.size();
 
-      for (Determinand *determinand : *determinands) {
-        if (determinand->getUnitLabel() == "garber c") {
-          QString determinandLabel =
-              QString::fromStdString(determinand->getDefinition());
+      for (auto determinand : determinands) {
+        if (determinand.getUnitLabel() == "garber c") {
+          QString determinandLabel = determinand.getQDefinition();
           determinandLabel.remove("Bathing Water Profile : ");
 
           if (!litterData[locationLabel].contains(determinandLabel))
@@ -89,12 +99,11 @@ void EnvironmentalLitterPage::aggregateData(WaterDataset &dataset) {
 
 void EnvironmentalLitterPage::updateComplianceSummary() {
   if (complianceStatus.empty()) {
+    if (complianceSummaryLabel)
+      complianceSummaryLabel->hide();
     return;
   }
 
-  if (!complianceSummaryLabel)
-    delete complianceSummaryLabel; // Delete old label to avoid duplication
-
   int totalLocations = complianceStatus.size();
   int compliantLocations = 0;
 
@@ -113,12 +122,16 @@ void EnvironmentalLitterPage::updateComplianceSummary() {
                              : (compliantLocations > 0) ? "Caution"
                                                         : "Non-Compliant";
 
-  complianceSummaryLabel = new QLabel(complianceSummary);
-  complianceSummaryLabel->setAlignment(Qt::AlignCenter);
+  // one banner, updated for every dataset shown
+  if (!complianceSummaryLabel) {
+    complianceSummaryLabel = new QLabel();
+    complianceSummaryLabel->setAlignment(Qt::AlignCenter);
+    layout()->addWidget(
+        complianceSummaryLabel); // Add the label to the main layout
+  }
+  complianceSummaryLabel->setText(complianceSummary);
   complianceSummaryLabel->setStyleSheet(getComplianceStyle(complianceStatus));
-
-  layout()->addWidget(
-      complianceSummaryLabel); // Add the label to the main layout
+  complianceSummaryLabel->show();
 }
 
 void EnvironmentalLitterPage::calculateCompliance() {
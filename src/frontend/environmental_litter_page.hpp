@@ -19,7 +19,7 @@ private:
   QBarSeries *barSeries;
   QMap<QString, QMap<QString, int>> litterData;
 
-  QLabel *complianceSummaryLabel;
+  QLabel *complianceSummaryLabel = nullptr;
   QMap<QString, int> totalDeterminands; // Total determinands for each location
   QMap<QString, QString>
       complianceStatus; // Compliance status for each location
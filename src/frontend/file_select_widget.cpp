@@ -12,19 +12,25 @@ FileSelectWidget::FileSelectWidget(QWidget *parent) {
   load->setText("load data");
   layout->addWidget(load);
 
-  label->setToolTip("select a CSV File");
+  label->setToolTip("select one or more CSV files");
   load->setToolTip("load data");
 
   connect(load, &QPushButton::clicked, this, &FileSelectWidget::onLoadClicked);
 }
 
 void FileSelectWidget::openCSV() {
-  filename = QFileDialog::getOpenFileName(this, "Select a CSV file", QString(),
-                                          "CSV files (*.csv);;All Files (*)");
+  filenames = QFileDialog::getOpenFileNames(
+      this, "Select CSV files", QString(),
+      "CSV files (*.csv *.csv.gz *.csv.zst);;JSON exports (*.json *.jsonld);;"
+      "All Files (*)");
 
-  if (!filename.isEmpty()) {
+  if (filenames.size() == 1) {
     // get last 20 characters of filename
+    const QString &filename = filenames.first();
     label->setText(filename.mid(filename.length() - 20, 20));
+  } else if (!filenames.isEmpty()) {
+    label->setText(QString("%1 files").arg(filenames.size()));
+    label->setToolTip(filenames.join("\n"));
   }
 }
 
@@ -35,4 +41,4 @@ void FileSelectWidget::mousePressEvent(QMouseEvent *event) {
     QWidget::mousePressEvent(event);
 }
 
-void FileSelectWidget::onLoadClicked() { emit fileSelected(filename); }
+void FileSelectWidget::onLoadClicked() { emit filesSelected(filenames); }
@@ -9,12 +9,12 @@ public:
   FileSelectWidget(QWidget *parent = nullptr);
 
 signals:
-  void fileSelected(QString &filename);
+  void filesSelected(QStringList &filenames);
 
 private:
   QHBoxLayout *layout;
   QLabel *label;
-  QString filename;
+  QStringList filenames;
   QPushButton *load;
 
   void openCSV();
@@ -98,34 +98,56 @@ bool FluorinatedCompoundsPage::isPFASCompound(const QString &determinandLabel, c
     return false;
 }
 
+// Classify each distinct determinand once instead of lower-casing its label
+// and definition for every row.
+bool FluorinatedCompoundsPage::isPFASDeterminand(const Determinand &determinand) {
+    signed char &pfas = pfasDeterminands[determinand.getId()];
+    if (pfas < 0) {
+        pfas = isPFASCompound(determinand.getQLabel(),
+                              determinand.getQDefinition());
+    }
+    return pfas;
+}
+
 void FluorinatedCompoundsPage::handleLocationChanged(const QString& location) {
     updateChart(location);
 }
 
 void FluorinatedCompoundsPage::updateData(WaterDataset* dataset) {
     currentDataset = dataset;
-    if (!dataset || !dataset->getData()) return;
+    if (!dataset) {
+        // nothing to show, e.g. a first load that failed
+        QSignalBlocker blocker(locationComboBox);
+        locationComboBox->clear();
+        locationComboBox->addItem("All Locations");
+        safePoints->clear();
+        warningPoints->clear();
+        dangerPoints->clear();
+        return;
+    }
+
+    pfasDeterminands.assign(dataset->getColumns().determinandCount(), -1);
 
+    // called again for every partial dataset and every append, so the
+    // selected location is kept if it is still there
+    QString selected = locationComboBox->currentText();
+    QSignalBlocker blocker(locationComboBox);
     locationComboBox->clear();
     locationComboBox->addItem("All Locations");
 
-    set<string> locations;  // 使用set去重
+    set<QString> locations;  // 使用set去重
 
     // 只收集有效 PFAS 数据的地点（result > 0）
-    for (const auto& samplingPoint : *dataset->getData()) {
-        if (!samplingPoint.second->getSamples()) continue;
+    for (auto samplingPoint : dataset->getPoints()) {
+        if (!samplingPoint.hasSamples()) continue;
 
         bool hasPFAS = false;
-        for (const auto& sample : *samplingPoint.second->getSamples()) {
-            if (!sample->getDeterminands()) continue;
-
-            for (const auto& determinand : *sample->getDeterminands()) {
-                if (isPFASCompound(
-                        QString::fromStdString(determinand->getLabel()),
-                        QString::fromStdString(determinand->getDefinition()))) {
+        for (auto sample : samplingPoint.getSamples()) {
+            for (auto determinand : sample.getDeterminands()) {
+                if (isPFASDeterminand(determinand)) {
                     // 检查测定值是否大于0
-                    if (determinand->getResult() > 0) {
-                        locations.insert(samplingPoint.second->getLabel());
+                    if (determinand.getResult() > 0) {
+                        locations.insert(samplingPoint.getQLabel());
                         hasPFAS = true;
                         break;
                     }
@@ -137,11 +159,13 @@ void FluorinatedCompoundsPage::updateData(WaterDataset* dataset) {
 
     // 添加到下拉框
     for (const auto& location : locations) {
-        locationComboBox->addItem(QString::fromStdString(location));
+        locationComboBox->addItem(location);
     }
+    locationComboBox->setCurrentIndex(
+        max(0, locationComboBox->findText(selected)));
 
     // 更新图表
-    updateChart();
+    updateChart(locationComboBox->currentText());
 }
 
 void FluorinatedCompoundsPage::updateChart(const QString& selectedLocation) {
@@ -153,36 +177,27 @@ void FluorinatedCompoundsPage::updateChart(const QString& selectedLocation) {
 
     double minY = std::numeric_limits<double>::max();
     double maxY = std::numeric_limits<double>::lowest();
-    QDateTime firstDate, lastDate;
+    qint64 firstTime = std::numeric_limits<qint64>::max();
+    qint64 lastTime = std::numeric_limits<qint64>::lowest();
 
     double threshold = getSafetyThreshold();
     bool filterLocation = !selectedLocation.isEmpty() && selectedLocation != "All Locations";
 
-    for (const auto& samplingPoint : *currentDataset->getData()) {
+    for (auto samplingPoint : currentDataset->getPoints()) {
         // 地点过滤
         if (filterLocation &&
-            QString::fromStdString(samplingPoint.second->getLabel()) != selectedLocation) {
+            samplingPoint.getQLabel() != selectedLocation) {
             continue;
         }
 
-        if (!samplingPoint.second->getSamples()) continue;
-
-        for (const auto& sample : *samplingPoint.second->getSamples()) {
-            if (!sample->getDeterminands()) continue;
-
-            QDateTime dateTime = QDateTime::fromString(
-                QString::fromStdString(sample->getDateTime()),
-                Qt::ISODate
-            );
-            if (!dateTime.isValid()) continue;
-            qint64 timestamp = dateTime.toMSecsSinceEpoch();
+        for (auto sample : samplingPoint.getSamples()) {
+            if (!sample.hasTimestamp()) continue;
+            qint64 timestamp = sample.getTimestamp();
 
-            for (const auto& determinand : *sample->getDeterminands()) {
-                if (isPFASCompound(
-                        QString::fromStdString(determinand->getLabel()),
-                        QString::fromStdString(determinand->getDefinition()))) {
+            for (auto determinand : sample.getDeterminands()) {
+                if (isPFASDeterminand(determinand)) {
 
-                    double value = determinand->getResult();
+                    double value = determinand.getResult();
                     // 只处理大于0的值
                     if (value > 0) {
                         QPointF point(timestamp, value);
@@ -197,8 +212,8 @@ void FluorinatedCompoundsPage::updateChart(const QString& selectedLocation) {
                         minY = qMin(minY, value);
                         maxY = qMax(maxY, value);
 
-                        if (firstDate.isNull() || dateTime < firstDate) firstDate = dateTime;
-                        if (lastDate.isNull() || dateTime > lastDate) lastDate = dateTime;
+                        firstTime = qMin(firstTime, timestamp);
+                        lastTime = qMax(lastTime, timestamp);
                     }
                 }
             }
@@ -214,7 +229,8 @@ void FluorinatedCompoundsPage::updateChart(const QString& selectedLocation) {
 
     if (totalPoints > 0) {
         if (QDateTimeAxis *axisX = qobject_cast<QDateTimeAxis*>(chart->axes(Qt::Horizontal).first())) {
-            axisX->setRange(firstDate, lastDate);
+            axisX->setRange(QDateTime::fromMSecsSinceEpoch(firstTime),
+                            QDateTime::fromMSecsSinceEpoch(lastTime));
         }
 
         if (QValueAxis *axisY = qobject_cast<QValueAxis*>(chart->axes(Qt::Vertical).first())) {
@@ -233,22 +249,18 @@ void FluorinatedCompoundsPage::updateChart(const QString& selectedLocation) {
 }
 
 void FluorinatedCompoundsPage::handlePointClicked(const QPointF &point) {
-    if (!currentDataset || !currentDataset->getData()) return;
+    if (!currentDataset) return;
 
-    QDateTime clickedDateTime = QDateTime::fromMSecsSinceEpoch(point.x());
+    qint64 clickedTime = point.x();
+    QDateTime clickedDateTime = QDateTime::fromMSecsSinceEpoch(clickedTime);
     double concentration = point.y();
 
-    for (const auto& samplingPoint : *currentDataset->getData()) {
-        if (!samplingPoint.second->getSamples()) continue;
-
-        for (const auto& sample : *samplingPoint.second->getSamples()) {
-            QDateTime sampleDateTime = QDateTime::fromString(
-                QString::fromStdString(sample->getDateTime()),
-                Qt::ISODate
-            );
+    for (auto samplingPoint : currentDataset->getPoints()) {
+        if (!samplingPoint.hasSamples()) continue;
 
-            if (sampleDateTime == clickedDateTime) {
-                QString location = QString::fromStdString(samplingPoint.second->getLabel());
+        for (auto sample : samplingPoint.getSamples()) {
+            if (sample.hasTimestamp() && sample.getTimestamp() == clickedTime) {
+                QString location = samplingPoint.getQLabel();
                 showDataPointDetails(point, location, concentration,
                                    clickedDateTime.toString(Qt::ISODate));
                 return;
@@ -14,6 +14,7 @@
 #include <QDialog>
 #include <QComboBox>
 #include "dataset.hpp"
+#include <vector>
 
 class FluorinatedCompoundsPage : public QWidget {
     Q_OBJECT
@@ -41,7 +42,10 @@ private:
     QComboBox *locationComboBox;  // 新增：地点选择下拉框
     WaterDataset* currentDataset;
 
+    std::vector<signed char> pfasDeterminands;  // per determinand id, -1 = unknown
+
     bool isPFASCompound(const QString &determinandLabel, const QString &definition);
+    bool isPFASDeterminand(const Determinand &determinand);
     QString getPFASImplications(double concentration);
     double getSafetyThreshold() const { return 0.1; }
 };
@@ -0,0 +1,69 @@
+#include "load_status_widget.hpp"
+
+// fast enough to look live, slow enough to cost nothing
+static const int REFRESH_MS = 100;
+static const int BAR_STEPS = 1000;
+
+LoadStatusWidget::LoadStatusWidget(const LoadProgress &progress,
+                                   QWidget *parent)
+    : QWidget(parent), progress(progress) {
+  layout = new QHBoxLayout(this);
+
+  bar = new QProgressBar();
+  bar->setRange(0, BAR_STEPS);
+  bar->setMaximumWidth(160);
+  layout->addWidget(bar);
+
+  label = new QLabel();
+  layout->addWidget(label);
+
+  cancel = new QPushButton();
+  cancel->setText("cancel");
+  cancel->setToolTip("stop loading this file");
+  layout->addWidget(cancel);
+
+  timer = new QTimer(this);
+  timer->setInterval(REFRESH_MS);
+
+  connect(timer, &QTimer::timeout, this, &LoadStatusWidget::refresh);
+  connect(cancel, &QPushButton::clicked, this, [this] {
+    cancel->setEnabled(false);
+    label->setText("cancelling...");
+    emit cancelRequested();
+  });
+
+  hide();
+}
+
+void LoadStatusWidget::start() {
+  cancel->setEnabled(true);
+  refresh();
+  timer->start();
+  show();
+}
+
+void LoadStatusWidget::stop() {
+  timer->stop();
+  hide();
+}
+
+void LoadStatusWidget::refresh() {
+  if (progress.isCancelled())
+    return;
+
+  size_t total = progress.totalBytes.load(std::memory_order_relaxed);
+  size_t bytes = std::min(progress.bytes.load(std::memory_order_relaxed), total);
+  size_t rows = progress.rows.load(std::memory_order_relaxed);
+
+  if (total == 0) {
+    // not started on the csv yet (or reading a snapshot)
+    bar->setRange(0, 0);
+  } else {
+    bar->setRange(0, BAR_STEPS);
+    bar->setValue(int(double(bytes) / total * BAR_STEPS));
+  }
+  label->setText(QString("%1 / %2 MB, %3 rows")
+                     .arg(bytes / 1e6, 0, 'f', 1)
+                     .arg(total / 1e6, 0, 'f', 1)
+                     .arg(rows));
+}
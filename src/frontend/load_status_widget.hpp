@@ -0,0 +1,29 @@
+#pragma once
+
+#include "load_progress.hpp"
+#include <QtWidgets>
+
+// Toolbar readout of a running load: a progress bar, bytes/rows so far and a
+// cancel button. Polls the LoadProgress from the GUI thread on a timer.
+class LoadStatusWidget : public QWidget {
+  Q_OBJECT
+
+public:
+  LoadStatusWidget(const LoadProgress &progress, QWidget *parent = nullptr);
+
+  void start();
+  void stop();
+
+signals:
+  void cancelRequested();
+
+private:
+  const LoadProgress &progress;
+  QHBoxLayout *layout;
+  QProgressBar *bar;
+  QLabel *label;
+  QPushButton *cancel;
+  QTimer *timer;
+
+  void refresh();
+};
@@ -13,6 +13,7 @@
 #include <QtCharts/QDateTimeAxis>
 #include <QDebug>
 #include <QtCharts/QScatterSeries>
+#include <limits>
 
 PollutantAnalysisPage::PollutantAnalysisPage(QWidget *parent)
     : QWidget(parent), dataset(nullptr) {
@@ -154,34 +155,31 @@ void PollutantAnalysisPage::updateCards() {
     QVector<QPointF> fluorinatedData;
 
     // Traverse dataset and aggregate data
-    for (const auto &entry : *dataset->getData()) {
-        SamplingPoint *point = entry.second;
+    for (auto point : dataset->getPoints()) {
+        for (auto sample : point.getSamples()) {
+            if (!sample.hasTimestamp()) continue; // Skip invalid dates
+            qint64 timestamp = sample.getTimestamp();
 
-        for (const auto &sample : *point->getSamples()) {
-            QDateTime sampleDateTime = QDateTime::fromString(
-                QString::fromStdString(sample->getDateTime()), Qt::ISODate);
-            if (!sampleDateTime.isValid()) continue; // Skip invalid dates
+            for (auto determinand : sample.getDeterminands()) {
+                const QString &label = determinand.getQLabel();
+                double result = determinand.getResult();
 
-            for (const auto &determinand : *sample->getDeterminands()) {
-                QString label = QString::fromStdString(determinand->getLabel());
-                double result = determinand->getResult();
-
-                overviewData.append(QPointF(sampleDateTime.toMSecsSinceEpoch(), result));
+                overviewData.append(QPointF(timestamp, result));
 
                 if (label.contains("Phenoxy", Qt::CaseInsensitive) ||
                     label.contains("Endrin", Qt::CaseInsensitive)) {
-                    popsData.append(QPointF(sampleDateTime.toMSecsSinceEpoch(), result));
+                    popsData.append(QPointF(timestamp, result));
                 }
 
-                if ((determinand->getUnitLabel() == "garber c") ||  // Check for specific unit label
+                if ((determinand.getUnitLabel() == "garber c") ||  // Check for specific unit label
                     label.contains("Plastic", Qt::CaseInsensitive) ||
                     label.contains("Microplastic", Qt::CaseInsensitive)) {
-                    litterData.append(QPointF(sampleDateTime.toMSecsSinceEpoch(), result));
+                    litterData.append(QPointF(timestamp, result));
                 }
 
                 if (label.contains("Fluorinated", Qt::CaseInsensitive) ||
                     label.contains("Fluoride", Qt::CaseInsensitive)) {
-                    fluorinatedData.append(QPointF(sampleDateTime.toMSecsSinceEpoch(), result));
+                    fluorinatedData.append(QPointF(timestamp, result));
                 }
             }
         }
@@ -298,21 +296,18 @@ void PollutantAnalysisPage::performSearch(const QString &searchTerm) {
     QVector<QPointF> searchData;
 
     // Traverse the dataset and filter matching pollutants
-    for (const auto &entry : *dataset->getData()) {
-        SamplingPoint *point = entry.second;
-
-        for (const auto &sample : *point->getSamples()) {
-            QDateTime sampleDateTime = QDateTime::fromString(
-                QString::fromStdString(sample->getDateTime()), Qt::ISODate);
-            if (!sampleDateTime.isValid()) continue; // Skip invalid dates
+    for (auto point : dataset->getPoints()) {
+        for (auto sample : point.getSamples()) {
+            if (!sample.hasTimestamp()) continue; // Skip invalid dates
+            qint64 timestamp = sample.getTimestamp();
 
-            for (const auto &determinand : *sample->getDeterminands()) {
-                QString label = QString::fromStdString(determinand->getLabel());
-                double result = determinand->getResult();
+            for (auto determinand : sample.getDeterminands()) {
+                const QString &label = determinand.getQLabel();
+                double result = determinand.getResult();
 
                 // Match search term
                 if (label.contains(searchTerm, Qt::CaseInsensitive)) {
-                    searchData.append(QPointF(sampleDateTime.toMSecsSinceEpoch(), result));
+                    searchData.append(QPointF(timestamp, result));
                 }
             }
         }
@@ -418,23 +413,20 @@ void PollutantAnalysisPage::applyTimeRangeFilter(const QString &timeRange) {
     }
 
     // Find the latest timestamp in the dataset
-    QDateTime latestTime;
-    for (const auto &entry : *dataset->getData()) {
-        SamplingPoint *point = entry.second;
-
-        for (const auto &sample : *point->getSamples()) {
-            QDateTime sampleDateTime = QDateTime::fromString(
-                QString::fromStdString(sample->getDateTime()), Qt::ISODate);
-            if (sampleDateTime.isValid() && sampleDateTime > latestTime) {
-                latestTime = sampleDateTime;
+    qint64 latestTimestamp = std::numeric_limits<qint64>::lowest();
+    for (auto point : dataset->getPoints()) {
+        for (auto sample : point.getSamples()) {
+            if (sample.hasTimestamp() && sample.getTimestamp() > latestTimestamp) {
+                latestTimestamp = sample.getTimestamp();
             }
         }
     }
 
-    if (!latestTime.isValid()) {
+    if (latestTimestamp == std::numeric_limits<qint64>::lowest()) {
         QMessageBox::warning(this, "No Data", "Dataset contains no valid timestamps.");
         return;
     }
+    QDateTime latestTime = QDateTime::fromMSecsSinceEpoch(latestTimestamp);
 
     qDebug() << "Latest time in dataset:" << latestTime;
 
@@ -449,6 +441,8 @@ void PollutantAnalysisPage::applyTimeRangeFilter(const QString &timeRange) {
     }
 
     qDebug() << "Time range filter applied:" << startTime << "to" << latestTime;
+    qint64 startTimestamp = startTime.isValid() ? startTime.toMSecsSinceEpoch()
+                                                : std::numeric_limits<qint64>::lowest();
 
     // Initialize data vectors for all categories
     QVector<QPointF> overviewData;
@@ -457,37 +451,34 @@ void PollutantAnalysisPage::applyTimeRangeFilter(const QString &timeRange) {
     QVector<QPointF> fluorinatedData;
 
     // Filter the data based on the time range
-    for (const auto &entry : *dataset->getData()) {
-        SamplingPoint *point = entry.second;
-
-        for (const auto &sample : *point->getSamples()) {
-            QDateTime sampleDateTime = QDateTime::fromString(
-                QString::fromStdString(sample->getDateTime()), Qt::ISODate);
+    for (auto point : dataset->getPoints()) {
+        for (auto sample : point.getSamples()) {
+            qint64 timestamp = sample.getTimestamp();
 
-            if (!sampleDateTime.isValid() || sampleDateTime < startTime || sampleDateTime > latestTime)
+            if (!sample.hasTimestamp() || timestamp < startTimestamp || timestamp > latestTimestamp)
                 continue; // Skip invalid or out-of-range timestamps
 
-            for (const auto &determinand : *sample->getDeterminands()) {
-                QString label = QString::fromStdString(determinand->getLabel());
-                double result = determinand->getResult();
+            for (auto determinand : sample.getDeterminands()) {
+                const QString &label = determinand.getQLabel();
+                double result = determinand.getResult();
 
                 // Aggregate data into the correct category
-                overviewData.append(QPointF(sampleDateTime.toMSecsSinceEpoch(), result));
+                overviewData.append(QPointF(timestamp, result));
 
                 if (label.contains("Phenoxy", Qt::CaseInsensitive) ||
                     label.contains("Endrin", Qt::CaseInsensitive)) {
-                    popsData.append(QPointF(sampleDateTime.toMSecsSinceEpoch(), result));
+                    popsData.append(QPointF(timestamp, result));
                 }
 
-                if ((determinand->getUnitLabel() == "garber c") ||  // Check for specific unit label
+                if ((determinand.getUnitLabel() == "garber c") ||  // Check for specific unit label
                     label.contains("Plastic", Qt::CaseInsensitive) ||
                     label.contains("Microplastic", Qt::CaseInsensitive)) {
-                    litterData.append(QPointF(sampleDateTime.toMSecsSinceEpoch(), result));
+                    litterData.append(QPointF(timestamp, result));
                 }
 
                 if (label.contains("Fluorinated", Qt::CaseInsensitive) ||
                     label.contains("Fluoride", Qt::CaseInsensitive)) {
-                    fluorinatedData.append(QPointF(sampleDateTime.toMSecsSinceEpoch(), result));
+                    fluorinatedData.append(QPointF(timestamp, result));
                 }
             }
         }
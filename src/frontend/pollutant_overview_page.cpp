@@ -43,50 +43,85 @@ void PollutantOverviewPage::create_widgets() {
           &PollutantOverviewPage::pollutantSet);
 }
 
+// Called again for every partial dataset of a running load, so the current
+// location and pollutant are kept if the new dataset still has them.
 void PollutantOverviewPage::updateData(WaterDataset *dataset_in) {
-  location_select->clear();
-  dataset = dataset_in;
-  if (!dataset)
-    return;
+  QString location = location_select->currentText();
+  QString pollutant = pollutant_select->currentText();
 
-  set<string> locations;
-  for (const auto &point : *dataset->getData()) {
-    if (!point.second || !point.second->getSamples())
-      continue;
+  dataset = dataset_in;
+  current_points.clear();
+  {
+    QSignalBlocker blocker(location_select);
+    location_select->clear();
+    if (!dataset)
+      return;
+
+    set<QString> locations;
+    for (auto point : dataset->getPoints()) {
+      if (!point.hasSamples())
+        continue;
+
+      locations.insert(point.getQLabel());
+    }
 
-    locations.insert(point.second->getLabel());
+    for (const QString &label : locations) {
+      location_select->addItem(label);
+    }
+    location_select->setCurrentIndex(
+        max(0, location_select->findText(location)));
   }
 
-  for (const string &location : locations) {
-    location_select->addItem(QString::fromStdString(location));
+  locationSet();
+  int selected = pollutant_select->findText(pollutant);
+  if (selected >= 0)
+    pollutant_select->setCurrentIndex(selected);
+}
+
+// Only a new location or the one on screen needs any work.
+void PollutantOverviewPage::refreshPoints(const vector<SamplingPoint> &points) {
+  bool current = false;
+  for (auto point : points) {
+    if (location_select->findText(point.getQLabel()) < 0) {
+      updateData(dataset);
+      return;
+    }
+    current |= point.getQLabel() == location_select->currentText();
   }
+  if (!current)
+    return;
+
+  QString pollutant = pollutant_select->currentText();
+  locationSet();
+  int selected = pollutant_select->findText(pollutant);
+  if (selected >= 0)
+    pollutant_select->setCurrentIndex(selected);
 }
 
 void PollutantOverviewPage::locationSet() {
   auto location = location_select->currentText().toStdString();
-  current_point = dataset->getFromLabel(location);
-  if (!current_point)
+  current_points = dataset->getFromLabel(location);
+  if (current_points.empty())
     return;
 
   pollutant_select->clear();
-  set<string> pollutants;
+  set<QString> pollutants;
 
-  for (const auto &sample : *current_point->getSamples()) {
-    if (!sample->getDeterminands())
-      continue;
-
-    for (const auto &determinand : *sample->getDeterminands()) {
-      pollutants.insert(determinand->getLabel());
+  for (auto point : current_points) {
+    for (auto sample : point.getSamples()) {
+      for (auto determinand : sample.getDeterminands()) {
+        pollutants.insert(determinand.getQLabel());
+      }
     }
   }
 
   for (const auto &pollutant : pollutants) {
-    pollutant_select->addItem(QString::fromStdString(pollutant));
+    pollutant_select->addItem(pollutant);
   }
 }
 
 void PollutantOverviewPage::pollutantSet() {
-  if (!current_point)
+  if (current_points.empty())
     return;
 
   auto determinand_label = pollutant_select->currentText().toStdString();
@@ -97,23 +132,30 @@ void PollutantOverviewPage::pollutantSet() {
 
   QVector<QPointF> points;
 
-  for (const auto &sample : *current_point->getSamples()) {
-    double res = sample->getResultFromLabel(determinand_label);
+  for (auto point : current_points) {
+    for (auto sample : point.getSamples()) {
+      double res = sample.getResultFromLabel(determinand_label);
+      if (res == -1 || !sample.hasTimestamp())
+        continue;
 
-    QDateTime dateTime = QDateTime::fromString(
-        QString::fromStdString(sample->getDateTime()), Qt::ISODateWithMs);
+      QDateTime dateTime =
+          QDateTime::fromMSecsSinceEpoch(sample.getTimestamp());
+      points.push_back(QPointF(sample.getTimestamp(), res));
 
-    if (res == -1)
-      continue;
-    points.push_back(QPointF(dateTime.toMSecsSinceEpoch(), res));
+      minY = min(minY, res);
+      maxY = max(maxY, res);
 
-    minY = min(minY, res);
-    maxY = max(maxY, res);
+      if (firstDate.isNull() || dateTime < firstDate)
+        firstDate = dateTime;
+      if (lastDate.isNull() || dateTime > lastDate)
+        lastDate = dateTime;
+    }
+  }
 
-    if (firstDate.isNull() || dateTime < firstDate)
-      firstDate = dateTime;
-    if (lastDate.isNull() || dateTime > lastDate)
-      lastDate = dateTime;
+  // samples from several points interleave in time
+  if (current_points.size() > 1) {
+    sort(points.begin(), points.end(),
+         [](const QPointF &a, const QPointF &b) { return a.x() < b.x(); });
   }
 
   time_series->replace(points);
@@ -3,6 +3,7 @@
 #include "dataset.hpp"
 #include <QtCharts>
 #include <QtWidgets>
+#include <vector>
 
 class PollutantOverviewPage : public QWidget {
   Q_OBJECT
@@ -10,10 +11,13 @@ class PollutantOverviewPage : public QWidget {
 public:
   explicit PollutantOverviewPage(QWidget *parent = nullptr);
   void updateData(WaterDataset *dataset);
+  // rows were appended to the current dataset for these points
+  void refreshPoints(const std::vector<SamplingPoint> &points);
 
 private:
   WaterDataset *dataset;
-  SamplingPoint *current_point;
+  // every sampling point sharing the selected label
+  std::vector<SamplingPoint> current_points;
 
   QGridLayout *layout;
 
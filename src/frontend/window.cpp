@@ -3,6 +3,7 @@
 #include "dataset.hpp"
 #include "file_select_widget.hpp"
 #include "fluorinated_compounds_page.hpp"
+#include "load_status_widget.hpp"
 #include "pollutant_overview_page.hpp"
 #include "pollutant_analysis_page.h"
 
@@ -18,6 +19,20 @@ WaterSampleWindow::WaterSampleWindow() : QMainWindow() {
   setWindowTitle("Cw3 Water Sample Analysis application - Group 15");
 }
 
+WaterSampleWindow::~WaterSampleWindow() {
+  // the worker writes into members of this window
+  if (loadThread) {
+    progress.cancel();
+    loadThread->wait();
+    delete loading;
+  }
+  // a partial still queued for showPartial(), which will not run now
+  delete nextPartial;
+  watcher->stop();
+  delete preview;
+  delete dataset;
+}
+
 void WaterSampleWindow::createMainWidget() {
   toolbar = this->addToolBar("toolbar");
   createFileSelect();
@@ -40,30 +55,210 @@ void WaterSampleWindow::createFileSelect() {
   auto fileSelect = new FileSelectWidget(this);
 
   toolbar->addWidget(fileSelect);
-  connect(fileSelect, &FileSelectWidget::fileSelected, this,
+  connect(fileSelect, &FileSelectWidget::filesSelected, this,
           &WaterSampleWindow::loadDataset);
   fileSelect->show();
+
+  auto siteButton = new QPushButton("load site");
+  siteButton->setToolTip(
+      "load a single sampling point of a CSV file, using its row index");
+  toolbar->addWidget(siteButton);
+  connect(siteButton, &QPushButton::clicked, this,
+          &WaterSampleWindow::loadSite);
+
+  loadStatus = new LoadStatusWidget(progress, this);
+  toolbar->addWidget(loadStatus);
+  connect(loadStatus, &LoadStatusWidget::cancelRequested, this,
+          [this] { progress.cancel(); });
+
+  watchBox = new QCheckBox("watch");
+  watchBox->setToolTip(
+      "add rows appended to the loaded files, and new csv files in their "
+      "folders, as they arrive");
+  toolbar->addWidget(watchBox);
+  watcher = new DatasetWatcher(this);
+  connect(watchBox, &QCheckBox::toggled, this, &WaterSampleWindow::setWatching);
+  connect(watcher, &DatasetWatcher::pointsChanged, this,
+          &WaterSampleWindow::rowsAppended);
 }
 
-void WaterSampleWindow::loadDataset(QString &filename) {
-  try {
-    dataset = new WaterDataset();
-    dataset->loadData(filename);
+void WaterSampleWindow::loadDataset(QStringList &filenames) {
+  if (filenames.isEmpty())
+    return;
+  startLoad(filenames, [this, filenames](WaterDataset *loaded) {
+    loaded->loadFiles(filenames, &progress, [this](WaterDataset *partial) {
+      {
+        // only the newest partial is worth showing
+        std::lock_guard<std::mutex> lock(partialMutex);
+        delete nextPartial;
+        nextPartial = partial;
+      }
+      QMetaObject::invokeMethod(this, &WaterSampleWindow::showPartial,
+                                Qt::QueuedConnection);
+    });
+  });
+}
 
-    auto successmessage = new QLabel("csv loaded successfully");
-    toolbar->addWidget(successmessage);
-    QTimer::singleShot(5000, successmessage, &QLabel::hide);
+// One sampling point of a csv, read through its row index (see
+// WaterDataset::loadPoint) instead of the whole file
+void WaterSampleWindow::loadSite() {
+  QString filename = QFileDialog::getOpenFileName(
+      this, "Select a CSV file", QString(), "CSV files (*.csv);;All Files (*)");
+  if (filename.isEmpty())
+    return;
+  bool ok;
+  QString notation =
+      QInputDialog::getText(this, "Load one site", "Sampling point notation:",
+                            QLineEdit::Normal, QString(), &ok)
+          .trimmed();
+  if (!ok || notation.isEmpty())
+    return;
+
+  startLoad({filename}, [this, filename, notation](WaterDataset *loaded) {
+    // so the watcher only appends this point's rows as well
+    LoadSpec spec;
+    spec.points = {notation.toStdString()};
+    loaded->setLoadSpec(spec);
+    loaded->loadPoint(filename, notation.toStdString(), &progress);
+  });
+}
 
-    pollutant_overview_page->updateData(dataset);
-    if (fluorPage) {
-      fluorPage->updateData(dataset);
+// Runs `load` on a worker thread so the window keeps painting. The pages
+// are shown each partial dataset it publishes, then the complete one in
+// finishLoad().
+void WaterSampleWindow::startLoad(
+    const QStringList &filenames,
+    const std::function<void(WaterDataset *)> &load) {
+  if (loadThread) {
+    QMessageBox::information(this, "Loading",
+                             "A file is already loading, cancel it first.");
+    return;
+  }
+
+  // the current dataset is about to be replaced
+  watcher->stop();
+  pendingFiles = filenames;
+  pendingSizes.clear();
+  for (const auto &file : filenames)
+    pendingSizes.append(QFileInfo(file).size());
+
+  // Copies its text (no setMapText): the user's files may be saved over in
+  // place while they are shown, which a mapping would not survive.
+  auto loaded = new WaterDataset();
+  loading = loaded;
+  progress.reset();
+  loadError = nullptr;
+
+  loadThread = QThread::create([this, loaded, load] {
+    try {
+      load(loaded);
+    } catch (...) {
+      loadError = std::current_exception();
     }
-    environmentalLitterPage->updateData(dataset);
+  });
+  connect(loadThread, &QThread::finished, this,
+          [this, loaded] { finishLoad(loaded); });
+  loadThread->start();
+  loadStatus->start();
+}
 
+void WaterSampleWindow::finishLoad(WaterDataset *loaded) {
+  loadThread->wait();
+  loadThread->deleteLater();
+  loadThread = nullptr;
+  loading = nullptr;
+  loadStatus->stop();
+
+  try {
+    if (loadError)
+      std::rethrow_exception(loadError);
+  } catch (const LoadCancelled &) {
+    delete loaded;
+    if (preview) {
+      // What the pages show becomes the dataset. Only part of its files
+      // were read, so there is nothing for the watcher to follow.
+      delete dataset;
+      dataset = preview;
+      preview = nullptr;
+      loadedFiles.clear();
+      loadedSizes.clear();
+      auto cancelmessage = new QLabel("load cancelled, showing partial data");
+      toolbar->addWidget(cancelmessage);
+      QTimer::singleShot(5000, cancelmessage, &QLabel::hide);
+    }
+    setWatching(watchBox->isChecked());
+    return;
   } catch (const std::exception &error) {
+    delete loaded;
+    // back to the dataset from before, or to nothing for a first load
+    if (preview) {
+      showDataset(dataset);
+      delete preview;
+      preview = nullptr;
+    }
+    setWatching(watchBox->isChecked());
     QMessageBox::critical(this, "CSV File Error", error.what());
     return;
   }
+
+  auto previous = dataset;
+  dataset = loaded;
+  loadedFiles = pendingFiles;
+  loadedSizes = pendingSizes;
+  showDataset(dataset);
+  delete preview;
+  preview = nullptr;
+  // the pages have let go of it, and the watcher did when the load started
+  delete previous;
+  setWatching(watchBox->isChecked());
+
+  QString loadedText = "csv loaded successfully";
+  if (size_t repeats = dataset->getColumns().duplicateRows)
+    loadedText += QString(", %1 repeated rows dropped").arg(repeats);
+  auto successmessage = new QLabel(loadedText);
+  toolbar->addWidget(successmessage);
+  QTimer::singleShot(5000, successmessage, &QLabel::hide);
+}
+
+void WaterSampleWindow::showPartial() {
+  WaterDataset *partial;
+  {
+    std::lock_guard<std::mutex> lock(partialMutex);
+    partial = nextPartial;
+    nextPartial = nullptr;
+  }
+  // already shown by an earlier call
+  if (!partial)
+    return;
+  showDataset(partial);
+  // the pages have let go of the previous one
+  delete preview;
+  preview = partial;
+}
+
+void WaterSampleWindow::showDataset(WaterDataset *shown) {
+  pollutant_overview_page->updateData(shown);
+  if (fluorPage) {
+    fluorPage->updateData(shown);
+  }
+  environmentalLitterPage->updateData(shown);
+}
+
+void WaterSampleWindow::setWatching(bool on) {
+  if (on && dataset && !loadedFiles.isEmpty() && !loadThread)
+    watcher->watch(dataset, loadedFiles, loadedSizes);
+  else
+    watcher->stop();
+}
+
+// Only the overview's chart depends on which points changed, the other pages
+// aggregate over the whole dataset and are rebuilt.
+void WaterSampleWindow::rowsAppended(const std::vector<SamplingPoint> &points) {
+  pollutant_overview_page->refreshPoints(points);
+  if (fluorPage) {
+    fluorPage->updateData(dataset);
+  }
+  environmentalLitterPage->updateData(dataset);
 }
 
 void WaterSampleWindow::about() {
@@ -2,33 +2,74 @@
 #define WINDOW_HPP
 
 #include "dataset.hpp"
+#include "dataset_watcher.hpp"
 #include "environmental_litter_page.hpp"
 #include "fluorinated_compounds_page.hpp"
+#include "load_progress.hpp"
+#include "load_status_widget.hpp"
 #include "pollutant_overview_page.hpp"
 #include "pollutant_analysis_page.h"
 #include <QtWidgets>
+#include <exception>
+#include <functional>
+#include <mutex>
 
 class WaterSampleWindow : public QMainWindow {
   Q_OBJECT
 
 public:
   WaterSampleWindow();
+  ~WaterSampleWindow();
 
 private:
   void createMainWidget();
   void createFileSelect();
 
-  WaterDataset *dataset;
+  WaterDataset *dataset = nullptr;
   PollutantOverviewPage *pollutant_overview_page;
   FluorinatedCompoundsPage *fluorPage;
   EnvironmentalLitterPage *environmentalLitterPage;
   PollutantAnalysisPage* pollutantAnalysisPage;
   QTabWidget *pages;
   QToolBar *toolbar;
+  LoadStatusWidget *loadStatus;
+  QCheckBox *watchBox;
+  DatasetWatcher *watcher;
+
+  // the files behind `dataset` and their sizes when loading started (none
+  // for the partial data of a cancelled load), and the same for the load
+  // that is running
+  QStringList loadedFiles, pendingFiles;
+  QList<qint64> loadedSizes, pendingSizes;
+
+  // the load running on loadThread, if any; progress and loadError are
+  // written by that thread and read here once it has finished
+  QThread *loadThread = nullptr;
+  LoadProgress progress;
+  std::exception_ptr loadError;
+
+  // the dataset the running load fills, deleted here if the window closes
+  // first
+  WaterDataset *loading = nullptr;
+
+  // what the pages show while a load is still running, owned here, and the
+  // partial the worker has published for showPartial() to show next
+  WaterDataset *preview = nullptr;
+  WaterDataset *nextPartial = nullptr;
+  std::mutex partialMutex;
+
+  void showPartial();
+  void startLoad(const QStringList &filenames,
+                 const std::function<void(WaterDataset *)> &load);
+  void finishLoad(WaterDataset *loaded);
+  void showDataset(WaterDataset *shown);
+  void setWatching(bool on);
+  void rowsAppended(const std::vector<SamplingPoint> &points);
 
 private slots:
   void about();
-  void loadDataset(QString &);
+  void loadDataset(QStringList &);
+  void loadSite();
 };
 
 #endif // WINDOW_HPP